@@ -21,6 +21,16 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+typedef NSString* CLYStartupStage NS_EXTENSIBLE_STRING_ENUM;
+extern CLYStartupStage const CLYStartupStageCore;
+extern CLYStartupStage const CLYStartupStageSession;
+extern CLYStartupStage const CLYStartupStageCrashReporting;
+extern CLYStartupStage const CLYStartupStageViewTracking;
+extern CLYStartupStage const CLYStartupStageFeatures;
+extern CLYStartupStage const CLYStartupStageConsents;
+extern CLYStartupStage const CLYStartupStageTotal;
+extern CLYStartupStage const CLYStartupStageDeferred;
+
 @interface Countly : NSObject <Resettable>
 
 #pragma mark - Core
@@ -37,6 +47,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)startWithConfig:(CountlyConfig *)config;
 
+/**
+ * Returns durations of SDK startup stages in milliseconds, keyed by stage.
+ * @discussion Synchronous stages run on the thread @c startWithConfig: is called on, and @c CLYStartupStageTotal is their sum.
+ * @discussion @c CLYStartupStageDeferred runs on a background queue after @c startWithConfig: returns, and is included once it finishes.
+ * @discussion It covers loading persisted health check state and starting the health check request, not its network round trip.
+ * @return Dictionary of stage durations, empty if Countly has not been started yet
+ */
+- (NSDictionary<CLYStartupStage, NSNumber *> *)startupStageDurations;
+
 
 
 #pragma mark - Override Configuration
@@ -354,6 +373,22 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)recordEvent:(NSString *)key segmentation:(NSDictionary<NSString *, id> * _Nullable)segmentation count:(NSUInteger)count sum:(double)sum duration:(NSTimeInterval)duration;
 
+/**
+ * Records multiple events at once.
+ * @discussion Each event is an @c NSDictionary with a mandatory @c key, and optional @c segmentation (or @c sg), @c count, @c sum, @c dur (in seconds) and @c timestamp (in milliseconds since epoch) entries.
+ * @discussion Events with a @c timestamp are recorded with it, so previously buffered events can be backfilled. Otherwise current time is used.
+ * @discussion Events are validated and added to the event queue as a group. Invalid events and reserved event keys are skipped.
+ * @param events Array of event dictionaries
+ */
+- (void)recordEvents:(NSArray<NSDictionary<NSString *, id> *> *)events;
+
+/**
+ * Records multiple events at once from a JSON array string.
+ * @discussion JSON array should contain event objects in the same format as described in @c recordEvents: method.
+ * @param JSONString JSON array string of events
+ */
+- (void)recordEventsWithJSONString:(NSString *)JSONString;
+
 /**
  * Starts a timed event with given key to be ended later. Duration of timed event will be calculated on ending.
  * @discussion Trying to start an event with already started key will have no effect.
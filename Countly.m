@@ -8,12 +8,26 @@
 
 @interface Countly ()
 {
-    NSTimer* timer;
     BOOL isSuspended;
+    BOOL isJourneyTriggerFlushScheduled;
     CountlyConfig* _startConfig;
+    NSMutableDictionary<CLYStartupStage, NSNumber *>* _startupStageDurations;
+    NSTimeInterval _startupStageStartTime;
 }
 @end
 
+//NOTE: Journey trigger events recorded within this window are sent in one request, followed by one content refresh
+static const NSTimeInterval kCountlyJourneyTriggerFlushWindow = 0.5;
+
+CLYStartupStage const CLYStartupStageCore           = @"core";
+CLYStartupStage const CLYStartupStageSession        = @"session";
+CLYStartupStage const CLYStartupStageCrashReporting = @"crashReporting";
+CLYStartupStage const CLYStartupStageViewTracking   = @"viewTracking";
+CLYStartupStage const CLYStartupStageFeatures       = @"features";
+CLYStartupStage const CLYStartupStageConsents       = @"consents";
+CLYStartupStage const CLYStartupStageTotal          = @"total";
+CLYStartupStage const CLYStartupStageDeferred       = @"deferred";
+
 long long appLoadStartTime;
 // It holds the event id of previous recorded custom event.
 static NSString* previousEventID;
@@ -45,11 +59,8 @@ static dispatch_once_t onceToken;
 
 - (void)resetInstance {
     CLY_LOG_I(@"%s resetting the instance", __FUNCTION__);
-    // Invalidate timer to avoid callbacks to a deallocated instance between tests.
-    if (timer) {
-        [timer invalidate];
-        timer = nil;
-    }
+    // Cancel session tick to avoid callbacks to a deallocated instance between tests.
+    [CountlyTimerWheel.sharedInstance cancelTaskWithIdentifier:kCountlyTimerTaskSession];
     // Remove all notification observers to avoid duplicate registrations after re-init in tests.
     [NSNotificationCenter.defaultCenter removeObserver:self];
     isSuspended = NO;
@@ -97,6 +108,13 @@ static dispatch_once_t onceToken;
     if (CountlyCommon.sharedInstance.hasStarted_)
         return;
     
+    NSTimeInterval startupStartTime = NSProcessInfo.processInfo.systemUptime;
+    @synchronized (self)
+    {
+        _startupStageDurations = NSMutableDictionary.new;
+        _startupStageStartTime = startupStartTime;
+    }
+
     CountlyCommon.sharedInstance.hasStarted = YES;
     CountlyCommon.sharedInstance.enableDebug = config.enableDebug;
     CountlyCommon.sharedInstance.shouldIgnoreTrustCheck = config.shouldIgnoreTrustCheck;
@@ -152,6 +170,7 @@ static dispatch_once_t onceToken;
     
     CountlyConnectionManager.sharedInstance.appKey = config.appKey;
     CountlyConnectionManager.sharedInstance.host = config.host;
+    CountlyConnectionManager.sharedInstance.fallbackHosts = config.fallbackHosts;
     CountlyConnectionManager.sharedInstance.alwaysUsePOST = config.alwaysUsePOST;
     CountlyConnectionManager.sharedInstance.pinnedCertificates = config.pinnedCertificates;
     CountlyConnectionManager.sharedInstance.secretSalt = config.secretSalt;
@@ -169,6 +188,8 @@ static dispatch_once_t onceToken;
     NSDictionary* customMetricsTruncated = [config.customMetrics cly_truncated:@"Custom metric"];
     CountlyDeviceInfo.sharedInstance.customMetrics = [customMetricsTruncated cly_limited:@"Custom metric"];
 
+    [self markStartupStage:CLYStartupStageCore];
+
     if (config.providedUserProperties.count > 0) {
         CLY_LOG_I(@"%s applying providedUserProperties at init [%lu]", __FUNCTION__, (unsigned long)config.providedUserProperties.count);
         [Countly.sharedInstance.userProfile setProperties:config.providedUserProperties];
@@ -183,7 +204,6 @@ static dispatch_once_t onceToken;
     CountlyFeedbacksInternal.sharedInstance.sessionCount = config.starRatingSessionCount;
     CountlyFeedbacksInternal.sharedInstance.disableAskingForEachAppVersion = config.starRatingDisableAskingForEachAppVersion;
     CountlyFeedbacksInternal.sharedInstance.ratingCompletionForAutoAsk = config.starRatingCompletion;
-    [CountlyFeedbacksInternal.sharedInstance checkForStarRatingAutoAsk];
 #endif
     
     if(config.disableLocation)
@@ -200,6 +220,8 @@ static dispatch_once_t onceToken;
     else
         [CountlyCommon.sharedInstance recordOrientation];
     
+    [self markStartupStage:CLYStartupStageSession];
+
     //NOTE: If there is no consent for sessions, location info and attribution should be sent separately, as they cannot be sent with begin_session request.
 
 #if (TARGET_OS_IOS || TARGET_OS_VISION || TARGET_OS_OSX )
@@ -241,6 +263,8 @@ static dispatch_once_t onceToken;
         }
     }
 
+    [self markStartupStage:CLYStartupStageCrashReporting];
+
 #if (TARGET_OS_IOS || TARGET_OS_TV )
     if (config.enableAutomaticViewTracking || [config.features containsObject:CLYAutoViewTracking])
     {
@@ -269,8 +293,15 @@ static dispatch_once_t onceToken;
     if (config.globalViewSegmentation) {
         [CountlyViewTrackingInternal.sharedInstance setGlobalViewSegmentation:config.globalViewSegmentation];
     }
-    timer = [NSTimer timerWithTimeInterval:config.updateSessionPeriod target:self selector:@selector(onTimer:) userInfo:nil repeats:YES];
-    [NSRunLoop.mainRunLoop addTimer:timer forMode:NSRunLoopCommonModes];
+
+    [self markStartupStage:CLYStartupStageViewTracking];
+
+    __weak typeof(self) weakSelf = self;
+    [CountlyTimerWheel.sharedInstance scheduleTaskWithIdentifier:kCountlyTimerTaskSession interval:config.updateSessionPeriod repeats:YES task:^
+    {
+        //NOTE: Suspended state and session state are owned by main thread, where app lifecycle notifications arrive
+        dispatch_async(dispatch_get_main_queue(), ^{ [weakSelf onTimer]; });
+    }];
     
     CountlyRemoteConfigInternal.sharedInstance.isRCAutomaticTriggersEnabled = config.enableRemoteConfigAutomaticTriggers || config.enableRemoteConfig;
     CountlyRemoteConfigInternal.sharedInstance.isRCValueCachingEnabled = config.enableRemoteConfigValueCaching;
@@ -281,6 +312,7 @@ static dispatch_once_t onceToken;
     if (config.enrollABOnRCDownload) {
         CountlyRemoteConfigInternal.sharedInstance.enrollABOnRCDownload = config.enrollABOnRCDownload;
     }
+    CountlyRemoteConfigInternal.sharedInstance.remoteConfigTTL = config.remoteConfigTTL;
     [CountlyRemoteConfigInternal.sharedInstance downloadRemoteConfigAutomatically];
     if (config.apm.getAppStartTimestampOverride) {
         appLoadStartTime = config.apm.getAppStartTimestampOverride;
@@ -302,6 +334,8 @@ static dispatch_once_t onceToken;
     CountlyCommon.sharedInstance.enableOrientationTracking = config.enableOrientationTracking;
     [CountlyCommon.sharedInstance observeDeviceOrientationChanges];
     
+    [self markStartupStage:CLYStartupStageFeatures];
+
     [CountlyConnectionManager.sharedInstance proceedOnQueue];
     
     //TODO: Should move at the top after checking the the edge cases of current implementation
@@ -333,9 +367,69 @@ static dispatch_once_t onceToken;
     if (config.indirectAttribution)
         [self recordIndirectAttribution:config.indirectAttribution];
     
-    [CountlyHealthTracker.sharedInstance sendHealthCheck];
+    [self markStartupStage:CLYStartupStageConsents];
+    [self recordStartupStage:CLYStartupStageTotal duration:NSProcessInfo.processInfo.systemUptime - startupStartTime];
 
     CountlyCommon.sharedInstance.hasFinishedInit = YES;
+
+    [self startDeferredStartupStage];
+}
+
+- (void)startDeferredStartupStage
+{
+    //NOTE: Work nothing else in start depends on is deferred, so it is not counted in the caller's launch time
+    //NOTE: Deferred stage duration covers loading health check state and starting its request, as the request itself completes asynchronously
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^
+    {
+        if (!CountlyCommon.sharedInstance.hasStarted_)
+            return;
+
+        NSTimeInterval stageStartTime = NSProcessInfo.processInfo.systemUptime;
+        [CountlyHealthTracker.sharedInstance sendHealthCheck];
+        [self recordStartupStage:CLYStartupStageDeferred duration:NSProcessInfo.processInfo.systemUptime - stageStartTime];
+    });
+
+#if (TARGET_OS_IOS)
+    //NOTE: Star-rating dialog can only be presented on main thread, so it is checked on the next run loop cycle
+    dispatch_async(dispatch_get_main_queue(), ^
+    {
+        if (!CountlyCommon.sharedInstance.hasStarted_)
+            return;
+
+        [CountlyFeedbacksInternal.sharedInstance checkForStarRatingAutoAsk];
+    });
+#endif
+}
+
+- (void)markStartupStage:(CLYStartupStage)stage
+{
+    NSTimeInterval now = NSProcessInfo.processInfo.systemUptime;
+    NSTimeInterval stageStartTime;
+    @synchronized (self)
+    {
+        stageStartTime = _startupStageStartTime;
+        _startupStageStartTime = now;
+    }
+
+    [self recordStartupStage:stage duration:now - stageStartTime];
+}
+
+- (void)recordStartupStage:(CLYStartupStage)stage duration:(NSTimeInterval)duration
+{
+    CLY_LOG_V(@"%s stage: [%@] duration: [%.2f ms]", __FUNCTION__, stage, duration * 1000);
+
+    @synchronized (self)
+    {
+        _startupStageDurations[stage] = @(duration * 1000);
+    }
+}
+
+- (NSDictionary<CLYStartupStage, NSNumber *> *)startupStageDurations
+{
+    @synchronized (self)
+    {
+        return _startupStageDurations.copy ?: @{};
+    }
 }
 
 - (CountlyConfig *) checkAndFixInternalLimitsConfig:(CountlyConfig *)config
@@ -390,7 +484,7 @@ static dispatch_once_t onceToken;
 
 #pragma mark -
 
-- (void)onTimer:(NSTimer *)timer
+- (void)onTimer
 {
     CLY_LOG_D(@"%s tick is happening sending events, manualSessions: [%d], hybridSessions: [%d], isSuspended: [%d]", __FUNCTION__, CountlyCommon.sharedInstance.manualSessionHandling, CountlyCommon.sharedInstance.enableManualSessionControlHybridMode, isSuspended);
     if (isSuspended)
@@ -398,15 +492,17 @@ static dispatch_once_t onceToken;
     
     if (!CountlyCommon.sharedInstance.manualSessionHandling)
     {
-        [CountlyConnectionManager.sharedInstance updateSession];
+        [CountlyConnectionManager.sharedInstance updateSessionAndSendEvents];
     }
     // this condtion is called only when both manual session handling and hybrid mode is enabled.
     else if (CountlyCommon.sharedInstance.enableManualSessionControlHybridMode)
     {
-        [CountlyConnectionManager.sharedInstance updateSession];
+        [CountlyConnectionManager.sharedInstance updateSessionAndSendEvents];
+    }
+    else
+    {
+        [CountlyConnectionManager.sharedInstance sendEventsWithSaveIfNeeded];
     }
-    
-    [CountlyConnectionManager.sharedInstance sendEventsWithSaveIfNeeded];
 }
 
 - (void)suspend
@@ -511,12 +607,6 @@ static dispatch_once_t onceToken;
 - (void)dealloc
 {
     [NSNotificationCenter.defaultCenter removeObserver:self];
-    
-    if (timer)
-    {
-        [timer invalidate];
-        timer = nil;
-    }
 }
 
 
@@ -775,6 +865,9 @@ static dispatch_once_t onceToken;
         [self resume];
 
         [CountlyPersistency.sharedInstance clearAllTimedEvents];
+
+        //NOTE: New device ID without merge is a new user on server, so previously acknowledged values do not apply
+        [CountlyUserDetails.sharedInstance clearAcknowledgedValues];
     }
 
     
@@ -890,40 +983,174 @@ static dispatch_once_t onceToken;
 {
     CLY_LOG_I(@"%s key: [%@], segmentation: [%@], count: [%lu], sum: [%f], duration: [%f]", __FUNCTION__, key, segmentation, (unsigned long)count, sum, duration);
 
-    NSNumber* isReservedEvent = [self isReservedEvent:key];
+    CountlyEventRoute* route = [CountlyEventRouter.sharedInstance routeForEventKey:key];
 
-    if (isReservedEvent)
+    if (route.isReserved)
     {
         CLY_LOG_V(@"%s, A reserved event detected: %@", __FUNCTION__, key);
-        if (!isReservedEvent.boolValue)
+        if (!route.hasConsent)
         {
             CLY_LOG_W(@"%s, No consent given for the reserved event! Event will not be recorded.", __FUNCTION__);
             return;
         }
         CLY_LOG_V(@"%s, Specific consent given for the reserved event! So, it will be recorded.", __FUNCTION__);
-    } else if (!CountlyConsentManager.sharedInstance.consentForEvents) {
+    } else if (!route.hasConsent) {
         CLY_LOG_W(@"%s, Consent for events not given! Event will not be recorded.", __FUNCTION__);
         return;
     }
     
-    if (!CountlyServerConfig.sharedInstance.customEventTrackingEnabled)
+    if (!route.isAllowedByServerConfig)
     {
-        CLY_LOG_D(@"%s, aborted: Custom Event Tracking is disabled from server config!", __FUNCTION__);
+        CLY_LOG_D(@"%s, aborted: Event '%@' is disabled or filtered by server config!", __FUNCTION__, key);
         return;
     }
+    
+    // Validates types, truncates, limits and applies global (sb/sw) and event-specific (esb/esw) segmentation filters in a single pass
+    NSMutableDictionary* sanitizedSegmentation = [NSMutableDictionary dictionaryWithCapacity:MIN(segmentation.count, CountlyCommon.sharedInstance.maxSegmentationValues)];
+    [segmentation cly_sanitizeSegmentationInto:sanitizedSegmentation explanation:@"Event segmentation" reservedKeys:nil route:route];
 
-    if (![CountlyServerConfig.sharedInstance shouldRecordEvent:key])
+    [self recordSanitizedEvent:key segmentation:sanitizedSegmentation count:count sum:sum duration:duration ID:nil timestamp:CountlyCommon.sharedInstance.uniqueTimestamp];
+}
+
+- (void)recordEvents:(NSArray<NSDictionary<NSString *, id> *> *)events
+{
+    CLY_LOG_I(@"%s count: [%lu]", __FUNCTION__, (unsigned long)events.count);
+
+    if (![events isKindOfClass:NSArray.class] || !events.count)
     {
-        CLY_LOG_D(@"%s, aborted: Event '%@' is filtered by server config event filter!", __FUNCTION__, key);
+        CLY_LOG_W(@"%s, Events should be a non-empty array of event dictionaries! Events will not be recorded.", __FUNCTION__);
         return;
     }
-    
-    // Apply global segmentation filter (sb/sw) and event-specific segmentation filter (esb/esw)
-    NSDictionary* filtered = [CountlyServerConfig.sharedInstance filterSegmentation:segmentation eventKey:key];
-    filtered = [filtered cly_truncated:@"Event segmentation"];
-    segmentation = [filtered cly_limited:@"Event segmentation"];
 
-    [self recordEvent:key segmentation:segmentation count:count sum:sum duration:duration ID:nil timestamp:CountlyCommon.sharedInstance.uniqueTimestamp];
+    CountlyCommon* common = CountlyCommon.sharedInstance;
+    NSMutableArray<CountlyEvent *>* batch = [NSMutableArray arrayWithCapacity:events.count];
+    BOOL hasJourneyTrigger = NO;
+    //NOTE: IDs for the whole batch are allocated at once, skipped events just leave unused IDs behind
+    NSArray<NSString *>* eventIDs = [CountlyEventIDGenerator.sharedInstance nextIDs:events.count];
+    NSUInteger eventIndex = 0;
+
+#if __has_include(<os/lock.h>)
+    os_unfair_lock_lock(&previousEventLock);
+#endif
+    for (NSDictionary* descriptor in events)
+    {
+        NSString* eventID = eventIDs[eventIndex++];
+
+        if (![descriptor isKindOfClass:NSDictionary.class])
+        {
+            CLY_LOG_W(@"%s, Skipping the event as it is not a dictionary: %@", __FUNCTION__, descriptor);
+            continue;
+        }
+
+        NSString* key = descriptor[kCountlyEventKeyKey];
+        if (![key isKindOfClass:NSString.class] || !key.length)
+        {
+            CLY_LOG_W(@"%s, Skipping the event as its key is empty or invalid: %@", __FUNCTION__, descriptor);
+            continue;
+        }
+
+        CountlyEventRoute* route = [CountlyEventRouter.sharedInstance routeForEventKey:key];
+        if (route.isReserved)
+        {
+            CLY_LOG_W(@"%s, Skipping the event as reserved events can not be recorded in bulk: %@", __FUNCTION__, key);
+            continue;
+        }
+
+        NSString* truncatedKey = [key cly_truncatedKey:@"Event key"];
+        if (truncatedKey != key)
+        {
+            key = truncatedKey;
+            route = [CountlyEventRouter.sharedInstance routeForEventKey:key];
+        }
+
+        if (!route.hasConsent)
+        {
+            CLY_LOG_W(@"%s, Consent for events not given! Events will not be recorded.", __FUNCTION__);
+            break;
+        }
+
+        if (!route.isAllowedByServerConfig)
+        {
+            CLY_LOG_D(@"%s, Skipping the event as it is disabled or filtered by server config: %@", __FUNCTION__, key);
+            continue;
+        }
+
+        NSDictionary* segmentation = descriptor[@"sg"] ?: descriptor[kCountlyEventKeySegmentation];
+        if (segmentation && ![segmentation isKindOfClass:NSDictionary.class])
+        {
+            CLY_LOG_W(@"%s, Ignoring segmentation of the event as it is not a dictionary: %@", __FUNCTION__, key);
+            segmentation = nil;
+        }
+
+        NSMutableDictionary* sanitizedSegmentation = [NSMutableDictionary dictionaryWithCapacity:MIN(segmentation.count, common.maxSegmentationValues)];
+        [segmentation cly_sanitizeSegmentationInto:sanitizedSegmentation explanation:@"Event segmentation" reservedKeys:nil route:route];
+
+        NSNumber* count = descriptor[kCountlyEventKeyCount];
+        NSNumber* sum = descriptor[kCountlyEventKeySum];
+        NSNumber* duration = descriptor[kCountlyEventKeyDuration];
+        NSNumber* timestampInMs = descriptor[kCountlyEventKeyTimestamp];
+
+        //NOTE: Non-numeric and non-positive counts would wrap around as unsigned, so they are recorded as 1
+        NSUInteger eventCount = 1;
+        if ([count isKindOfClass:NSNumber.class] && count.longLongValue > 0)
+            eventCount = count.unsignedIntegerValue;
+        else if (count)
+            CLY_LOG_W(@"%s, Count of the event is not a positive number, it will be recorded as 1: %@", __FUNCTION__, key);
+
+        BOOL isBackfilled = [timestampInMs isKindOfClass:NSNumber.class] && timestampInMs.longLongValue > 0;
+        NSTimeInterval timestamp = isBackfilled ? timestampInMs.longLongValue / 1000.0 : common.uniqueTimestamp;
+
+        CountlyEvent* event = [self eventWithKey:key
+                                    segmentation:sanitizedSegmentation
+                                           count:eventCount
+                                             sum:[sum isKindOfClass:NSNumber.class] ? sum.doubleValue : 0
+                                        duration:[duration isKindOfClass:NSNumber.class] ? duration.doubleValue : 0
+                                              ID:eventID
+                                       timestamp:timestamp
+                                      isReserved:NO];
+
+        //NOTE: Backfilled events should report hour and day of week of their own timestamp
+        if (isBackfilled)
+        {
+            event.hourOfDay = [common hourOfDayForTimestamp:timestamp];
+            event.dayOfWeek = [common dayOfWeekForTimestamp:timestamp];
+        }
+
+        [batch addObject:event];
+        hasJourneyTrigger = hasJourneyTrigger || route.isJourneyTrigger;
+    }
+
+    [CountlyPersistency.sharedInstance recordEvents:batch callback:nil];
+#if __has_include(<os/lock.h>)
+    os_unfair_lock_unlock(&previousEventLock);
+#endif
+
+    if (hasJourneyTrigger)
+        [self scheduleJourneyTriggerFlush];
+
+    CLY_LOG_D(@"%s %lu of %lu events recorded", __FUNCTION__, (unsigned long)batch.count, (unsigned long)events.count);
+}
+
+- (void)recordEventsWithJSONString:(NSString *)JSONString
+{
+    CLY_LOG_I(@"%s", __FUNCTION__);
+
+    NSData* data = [JSONString cly_dataUTF8];
+    if (!data)
+    {
+        CLY_LOG_W(@"%s, JSON string is empty or invalid! Events will not be recorded.", __FUNCTION__);
+        return;
+    }
+
+    NSError* error = nil;
+    NSArray* events = [NSJSONSerialization JSONObjectWithData:data options:0 error:&error];
+    if (error || ![events isKindOfClass:NSArray.class])
+    {
+        CLY_LOG_W(@"%s, JSON string should be an array of event objects! Events will not be recorded. Error: %@", __FUNCTION__, error);
+        return;
+    }
+
+    [self recordEvents:events];
 }
 
 #pragma mark -
@@ -943,15 +1170,59 @@ static dispatch_once_t onceToken;
     [self recordEvent:key segmentation:segmentation count:count sum:sum duration:duration ID:ID timestamp:timestamp];
 }
 
+- (void)recordSanitizedReservedEvent:(NSString *)key segmentation:(NSMutableDictionary *)segmentation count:(NSUInteger)count sum:(double)sum duration:(NSTimeInterval)duration ID:(NSString *)ID timestamp:(NSTimeInterval)timestamp
+{
+    [self recordSanitizedEvent:key segmentation:segmentation count:count sum:sum duration:duration ID:ID timestamp:timestamp];
+}
+
 #pragma mark -
 
 - (void)recordEvent:(NSString *)key segmentation:(NSDictionary *)segmentation count:(NSUInteger)count sum:(double)sum duration:(NSTimeInterval)duration ID:(NSString *)ID timestamp:(NSTimeInterval)timestamp
+{
+    [self recordSanitizedEvent:key segmentation:segmentation.cly_filterSupportedDataTypes count:count sum:sum duration:duration ID:ID timestamp:timestamp];
+}
+
+//NOTE: Given segmentation must already contain only supported data types, and it is mutated in place.
+- (void)recordSanitizedEvent:(NSString *)key segmentation:(NSMutableDictionary *)segmentation count:(NSUInteger)count sum:(double)sum duration:(NSTimeInterval)duration ID:(NSString *)ID timestamp:(NSTimeInterval)timestamp
 {
     if (key.length == 0) {
         CLY_LOG_D(@"%s omitting the call, key is empty", __FUNCTION__);
         return;
     }
 
+    CountlyEventRoute* route = [CountlyEventRouter.sharedInstance routeForEventKey:key];
+
+    if (!route.isReserved)
+    {
+        CLY_LOG_V(@"%s will add event id and name properties because it is not a reserved event ", __FUNCTION__);
+        NSString* truncatedKey = [key cly_truncatedKey:@"Event key"];
+        if (truncatedKey != key)
+        {
+            key = truncatedKey;
+            route = [CountlyEventRouter.sharedInstance routeForEventKey:key];
+        }
+#if __has_include(<os/lock.h>)
+        os_unfair_lock_lock(&previousEventLock);
+#endif
+        CountlyEvent* event = [self eventWithKey:key segmentation:segmentation count:count sum:sum duration:duration ID:ID timestamp:timestamp isReserved:NO];
+        [CountlyPersistency.sharedInstance recordEvent:event callback:nil];
+#if __has_include(<os/lock.h>)
+        os_unfair_lock_unlock(&previousEventLock);
+#endif
+
+        if (route.isJourneyTrigger)
+            [self scheduleJourneyTriggerFlush];
+    }
+    else
+    {
+        CountlyEvent* event = [self eventWithKey:key segmentation:segmentation count:count sum:sum duration:duration ID:ID timestamp:timestamp isReserved:YES];
+        [CountlyPersistency.sharedInstance recordEvent:event];
+    }
+}
+
+//NOTE: For non-reserved events, this must be called while holding previousEventLock, as it advances previous event ID and name chain.
+- (CountlyEvent *)eventWithKey:(NSString *)key segmentation:(NSMutableDictionary *)segmentation count:(NSUInteger)count sum:(double)sum duration:(NSTimeInterval)duration ID:(NSString *)ID timestamp:(NSTimeInterval)timestamp isReserved:(BOOL)isReserved
+{
     CountlyEvent *event = CountlyEvent.new;
     event.ID = ID;
     if (!event.ID.length)
@@ -959,19 +1230,17 @@ static dispatch_once_t onceToken;
         event.ID = CountlyCommon.sharedInstance.randomEventID;
     }
 
+    CountlyViewTrackingInternal* viewTracking = CountlyViewTrackingInternal.sharedInstance;
     if ([key isEqualToString:kCountlyReservedEventView])
     {
-        event.PVID = CountlyViewTrackingInternal.sharedInstance.previousViewID ?: @"";
+        event.PVID = viewTracking.previousViewID ?: @"";
     }
     else
     {
-        event.CVID = CountlyViewTrackingInternal.sharedInstance.currentViewID ?: @"";
+        event.CVID = viewTracking.currentViewID ?: @"";
     }
 
-    // Check if the event is a reserved event
-    BOOL isReservedEvent = [self isReservedEvent:key];
-
-    NSMutableDictionary *filteredSegmentations = segmentation.cly_filterSupportedDataTypes;
+    NSMutableDictionary *filteredSegmentations = segmentation;
     if(filteredSegmentations == nil)
         filteredSegmentations = NSMutableDictionary.new;
 
@@ -981,53 +1250,62 @@ static dispatch_once_t onceToken;
     event.hourOfDay = CountlyCommon.sharedInstance.hourOfDay;
     event.dayOfWeek = CountlyCommon.sharedInstance.dayOfWeek;
     event.duration = duration;
-    
-    if (!isReservedEvent)
+    event.key = key;
+
+    if (!isReserved)
     {
-        CLY_LOG_V(@"%s will add event id and name properties because it is not a reserved event ", __FUNCTION__);
-        key = [key cly_truncatedKey:@"Event key"];
-        NSString* capturedPreviousID = nil;
-        NSString* capturedPreviousName = nil;
-#if __has_include(<os/lock.h>)
-        os_unfair_lock_lock(&previousEventLock);
-#endif
-        capturedPreviousID = previousEventID;
+        BOOL enablePreviousNameRecording = viewTracking.enablePreviousNameRecording;
+        event.PEID = previousEventID ?: @"";
         previousEventID = event.ID; // update chain
-        if(CountlyViewTrackingInternal.sharedInstance.enablePreviousNameRecording) {
-            capturedPreviousName = previousEventName;
+        if(enablePreviousNameRecording) {
+            filteredSegmentations[kCountlyPreviousEventName] = previousEventName ?: @"";
+            filteredSegmentations[kCountlyCurrentView] = viewTracking.currentViewName ?: @"";
             previousEventName = key;
         }
-        event.PEID = capturedPreviousID ?: @"";
-        if(CountlyViewTrackingInternal.sharedInstance.enablePreviousNameRecording) {
-            filteredSegmentations[kCountlyPreviousEventName] = capturedPreviousName ?: @"";
-            filteredSegmentations[kCountlyCurrentView] = CountlyViewTrackingInternal.sharedInstance.currentViewName ?: @"";
-        }
-        event.key = key;
-        event.segmentation = [self processSegmentation:filteredSegmentations eventKey:key];
-        id callback = nil;
-        if ([CountlyServerConfig.sharedInstance isJourneyTriggerEvent:key]){
-            callback = ^(NSString *response, BOOL success) {
-                if (success)
-                {
-    #if (TARGET_OS_IOS)
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        [CountlyContentBuilderInternal.sharedInstance refreshContentZoneJTE];
-                    });
-    #endif
-                }
-            };
-        }
-        [CountlyPersistency.sharedInstance recordEvent:event callback:callback];
-#if __has_include(<os/lock.h>)
-        os_unfair_lock_unlock(&previousEventLock);
-#endif
     }
-    else
+
+    event.segmentation = [self processSegmentation:filteredSegmentations eventKey:key];
+    return event;
+}
+
+- (void)scheduleJourneyTriggerFlush
+{
+    @synchronized (self)
     {
-        event.key = key;
-        event.segmentation = [self processSegmentation:filteredSegmentations eventKey:key];
-        [CountlyPersistency.sharedInstance recordEvent:event];
+        if (isJourneyTriggerFlushScheduled)
+            return;
+
+        isJourneyTriggerFlushScheduled = YES;
     }
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kCountlyJourneyTriggerFlushWindow * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [self flushJourneyTriggerEvents];
+    });
+}
+
+- (void)flushJourneyTriggerEvents
+{
+    @synchronized (self)
+    {
+        isJourneyTriggerFlushScheduled = NO;
+    }
+
+    CLY_LOG_D(@"%s, sending coalesced journey trigger events", __FUNCTION__);
+    [CountlyConnectionManager.sharedInstance sendEventsWithCallback:[self journeyTriggerEventCallback]];
+}
+
+- (CLYRequestCallback)journeyTriggerEventCallback
+{
+    return ^(NSString *response, BOOL success) {
+        if (success)
+        {
+#if (TARGET_OS_IOS)
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [CountlyContentBuilderInternal.sharedInstance refreshContentZoneJTE];
+            });
+#endif
+        }
+    };
 }
 
 - (NSDictionary *)processSegmentation:(NSMutableDictionary *)segmentation eventKey:(NSString *)eventKey {
@@ -1067,23 +1345,6 @@ static dispatch_once_t onceToken;
 #endif
 }
 
-/// This checks that given key requires any extra consent
-- (NSNumber *)isReservedEvent:(NSString *)key
-{
-    NSDictionary <NSString *, NSNumber *>* reservedEvents =
-    @{
-        kCountlyReservedEventOrientation: @(CountlyConsentManager.sharedInstance.consentForUserDetails),
-        kCountlyReservedEventStarRating: @(CountlyConsentManager.sharedInstance.consentForFeedback),
-        kCountlyReservedEventSurvey: @(CountlyConsentManager.sharedInstance.consentForFeedback),
-        kCountlyReservedEventNPS: @(CountlyConsentManager.sharedInstance.consentForFeedback),
-        kCountlyReservedEventPushAction: @(CountlyConsentManager.sharedInstance.consentForPushNotifications),
-        kCountlyReservedEventView: @(CountlyConsentManager.sharedInstance.consentForViewTracking),
-    };
-
-    NSNumber* aReservedEvent = reservedEvents[key];
-    return aReservedEvent;
-}
-
 #pragma mark -
 
 - (void)startEvent:(NSString *)key
@@ -1096,6 +1357,7 @@ static dispatch_once_t onceToken;
     CountlyEvent *event = CountlyEvent.new;
     event.key = key;
     event.timestamp = CountlyCommon.sharedInstance.uniqueTimestamp;
+    event.monotonicStartTime = CountlyClock.sharedInstance.monotonicTime;
 
     [CountlyPersistency.sharedInstance recordTimedEvent:event];
 }
@@ -1120,7 +1382,7 @@ static dispatch_once_t onceToken;
         return;
     }
 
-    NSTimeInterval duration = NSDate.date.timeIntervalSince1970 - event.timestamp;
+    NSTimeInterval duration = CountlyClock.sharedInstance.monotonicTime - event.monotonicStartTime;
     [self recordEvent:key segmentation:segmentation count:count sum:sum duration:duration];
 }
 
@@ -1546,6 +1808,12 @@ static dispatch_once_t onceToken;
         [CountlyPerformanceMonitoring.sharedInstance clearAllCustomTraces];
     }
 
+    // Remove remote config change callbacks and key observers (safe operation - just clears collections)
+    if (CountlyRemoteConfigInternal.sharedInstance)
+    {
+        [CountlyRemoteConfigInternal.sharedInstance removeAllChangeListeners];
+    }
+
     // Note: CountlyRemoteConfigInternal.clearAll is not called here because it triggers
     // storeRemoteConfig which involves file I/O and can block during shutdown.
     // Remote config state will persist across halt/start but is cleared via UserDefaults
@@ -1556,10 +1824,13 @@ static dispatch_once_t onceToken;
     [CountlyDeviceInfo.sharedInstance resetInstance];
     [CountlyConnectionManager.sharedInstance resetInstance];
     [CountlyServerConfig.sharedInstance resetInstance];
+    [CountlyEventRouter.sharedInstance resetInstance];
 #if (TARGET_OS_IOS)
     [CountlyContentBuilderInternal.sharedInstance resetInstance];
 #endif
+    [CountlyTimerWheel.sharedInstance resetInstance];
     [CountlyUserDetails.sharedInstance clearUserDetails];
+    [CountlyUserDetails.sharedInstance unloadAcknowledgedValues];
     [self resetInstance];
     [CountlyCommon.sharedInstance resetInstance];
 
@@ -1572,6 +1843,7 @@ static dispatch_once_t onceToken;
         // environment (different bundle ID), so clear SDK keys manually
         NSArray* sdkKeys = @[
             @"kCountlyServerConfigPersistencyKey",
+            @"kCountlyUserDetailsHashesPersistencyKey",
             @"kCountlyHealthCheckStatePersistencyKey",
             @"kCountlyQueuedRequestsPersistencyKey",
             @"kCountlyStartedEventsPersistencyKey",
@@ -1579,6 +1851,7 @@ static dispatch_once_t onceToken;
             @"kCountlyStoredNSUUIDKey",
             @"kCountlyStarRatingStatusKey",
             @"kCountlyRemoteConfigKey",
+            @"kCountlyRemoteConfigFetchTimeKey",
             @"kCountlyIsCustomDeviceIDKey",
             @"kCountlyNotificationPermissionKey",
             @"kCountlyWatchParentDeviceIDKey"
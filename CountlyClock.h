@@ -0,0 +1,28 @@
+// CountlyClock.h
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+//NOTE: Single source of time for the SDK.
+//NOTE: Calendar fields are cached until the next hour boundary, or until system time zone or clock changes.
+//NOTE: Durations should be measured with monotonicTime, as wall clock jumps when user changes device time.
+@interface CountlyClock : NSObject
+
++ (instancetype)sharedInstance;
+
+- (NSInteger)hourOfDay;
+- (NSInteger)dayOfWeek;
+- (NSInteger)timeZone;
+
+- (long long)uniqueTimestampInMilliseconds;
+
+- (NSTimeInterval)monotonicTime;
+
+@end
+
+NS_ASSUME_NONNULL_END
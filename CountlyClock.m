@@ -0,0 +1,140 @@
+// CountlyClock.m
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import "CountlyCommon.h"
+#import <os/lock.h>
+#import <stdatomic.h>
+#import <time.h>
+
+typedef struct
+{
+    NSTimeInterval validFrom;
+    NSTimeInterval validUntil;
+    NSInteger hourOfDay;
+    NSInteger dayOfWeek;
+    NSInteger timeZone;
+} CountlyCalendarFields;
+
+@interface CountlyClock ()
+{
+    os_unfair_lock _calendarLock;
+    NSCalendar* _calendar;
+    CountlyCalendarFields _calendarFields;
+    _Atomic(long long) _lastTimestamp;
+}
+@end
+
+@implementation CountlyClock
+
++ (instancetype)sharedInstance
+{
+    static CountlyClock* s_sharedInstance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{s_sharedInstance = self.new;});
+    return s_sharedInstance;
+}
+
+- (instancetype)init
+{
+    if (self = [super init])
+    {
+        _calendarLock = OS_UNFAIR_LOCK_INIT;
+        _calendar = [NSCalendar.alloc initWithCalendarIdentifier:NSCalendarIdentifierGregorian];
+        atomic_init(&_lastTimestamp, 0);
+
+        [NSNotificationCenter.defaultCenter addObserver:self selector:@selector(systemTimeDidChange:) name:NSSystemTimeZoneDidChangeNotification object:nil];
+        [NSNotificationCenter.defaultCenter addObserver:self selector:@selector(systemTimeDidChange:) name:NSSystemClockDidChangeNotification object:nil];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [NSNotificationCenter.defaultCenter removeObserver:self];
+}
+
+- (void)systemTimeDidChange:(NSNotification *)notification
+{
+    CLY_LOG_D(@"%s %@, cached calendar fields will be recalculated", __FUNCTION__, notification.name);
+
+    [NSTimeZone resetSystemTimeZone];
+
+    os_unfair_lock_lock(&_calendarLock);
+    //NOTE: A new calendar picks up the current time zone
+    _calendar = [NSCalendar.alloc initWithCalendarIdentifier:NSCalendarIdentifierGregorian];
+    _calendarFields.validUntil = 0;
+    os_unfair_lock_unlock(&_calendarLock);
+}
+
+- (CountlyCalendarFields)calendarFields
+{
+    NSTimeInterval now = NSDate.date.timeIntervalSince1970;
+
+    os_unfair_lock_lock(&_calendarLock);
+
+    if (now < _calendarFields.validFrom || now >= _calendarFields.validUntil)
+    {
+        //NOTE: Hour, day of week and time zone offset (including DST transitions) can only change at an hour boundary
+        NSDate* date = [NSDate dateWithTimeIntervalSince1970:now];
+        NSDateComponents* components = [_calendar components:NSCalendarUnitHour | NSCalendarUnitWeekday fromDate:date];
+
+        NSDate* hourStart = nil;
+        NSTimeInterval hourLength = 0;
+        [_calendar rangeOfUnit:NSCalendarUnitHour startDate:&hourStart interval:&hourLength forDate:date];
+
+        _calendarFields.hourOfDay = components.hour;
+        _calendarFields.dayOfWeek = components.weekday - 1;
+        _calendarFields.timeZone = [NSTimeZone.systemTimeZone secondsFromGMTForDate:date] / 60;
+        _calendarFields.validFrom = hourStart ? hourStart.timeIntervalSince1970 : now;
+        _calendarFields.validUntil = hourStart ? _calendarFields.validFrom + hourLength : now;
+    }
+
+    CountlyCalendarFields calendarFields = _calendarFields;
+
+    os_unfair_lock_unlock(&_calendarLock);
+
+    return calendarFields;
+}
+
+- (NSInteger)hourOfDay
+{
+    return self.calendarFields.hourOfDay;
+}
+
+- (NSInteger)dayOfWeek
+{
+    return self.calendarFields.dayOfWeek;
+}
+
+- (NSInteger)timeZone
+{
+    return self.calendarFields.timeZone;
+}
+
+- (long long)uniqueTimestampInMilliseconds
+{
+    long long now = floor(NSDate.date.timeIntervalSince1970 * 1000);
+    long long last = atomic_load_explicit(&_lastTimestamp, memory_order_relaxed);
+    long long unique;
+
+    //NOTE: Each caller gets a distinct, increasing value, even if called concurrently within the same millisecond
+    do
+    {
+        unique = now > last ? now : last + 1;
+    }
+    while (!atomic_compare_exchange_weak_explicit(&_lastTimestamp, &last, unique, memory_order_relaxed, memory_order_relaxed));
+
+    return unique;
+}
+
+- (NSTimeInterval)monotonicTime
+{
+    //NOTE: Keeps counting while device sleeps, but is not affected by wall clock changes
+    return (NSTimeInterval)clock_gettime_nsec_np(CLOCK_MONOTONIC) / NSEC_PER_SEC;
+}
+
+@end
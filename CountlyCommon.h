@@ -32,6 +32,16 @@
 #import "CountlyContentBuilderInternal.h"
 #import "CountlyExperimentalConfig.h"
 #import "CountlyHealthTracker.h"
+#import "CountlyEventRouter.h"
+#import "CountlyEventArena.h"
+#import "CountlyJSONWriter.h"
+#import "CountlyNetworkStateMonitor.h"
+#import "CountlyHostSelector.h"
+#import "CountlyTimerWheel.h"
+#import "CountlyClock.h"
+#import "CountlyEventIDGenerator.h"
+#import "CountlyRemoteConfigSnapshot.h"
+#import "CountlyKeyMatcher.h"
 
 #define CLY_LOG_E(fmt, ...) CountlyInternalLog(CLYInternalLogLevelError, fmt, ##__VA_ARGS__)
 #define CLY_LOG_W(fmt, ...) CountlyInternalLog(CLYInternalLogLevelWarning, fmt, ##__VA_ARGS__)
@@ -105,6 +115,8 @@ void CountlyPrint(NSString *stringToPrint);
 + (instancetype)sharedInstance;
 - (NSInteger)hourOfDay;
 - (NSInteger)dayOfWeek;
+- (NSInteger)hourOfDayForTimestamp:(NSTimeInterval)timestamp;
+- (NSInteger)dayOfWeekForTimestamp:(NSTimeInterval)timestamp;
 - (NSInteger)timeZone;
 - (NSInteger)timeSinceLaunch;
 - (NSTimeInterval)uniqueTimestamp;
@@ -151,11 +163,16 @@ void CountlyPrint(NSString *stringToPrint);
 @property (nonatomic, weak) id originalDelegate;
 @end
 
+void CountlyQueryStringScan(NSString* queryString, __unsafe_unretained NSString* const _Nonnull * _Nonnull keys, NSRange* valueRanges, NSUInteger keyCount);
+
 @interface NSString (Countly)
 - (NSString *)cly_URLEscaped;
 - (NSString *)cly_SHA256;
+- (NSString *)cly_SHA256WithSuffix:(NSString * _Nullable)suffix;
 - (NSData *)cly_dataUTF8;
 - (NSString *)cly_valueForQueryStringKey:(NSString *)key;
+- (NSRange)cly_rangeOfValueForQueryStringKey:(NSString *)key;
+- (long long)cly_longLongValueForQueryStringKey:(NSString *)key;
 - (NSString *)cly_truncatedKey:(NSString *)explanation;
 - (NSString *)cly_truncatedValue:(NSString *)explanation;
 - (NSString *)cly_truncatedPictureValue:(NSString *)explanation;
@@ -164,6 +181,7 @@ void CountlyPrint(NSString *stringToPrint);
 @interface NSArray (Countly)
 - (NSString *)cly_JSONify;
 - (NSArray *)cly_filterSupportedDataTypes;
+- (NSArray *)cly_filterSupportedDataTypesIfNeeded;
 @end
 
 @interface NSDictionary (Countly)
@@ -171,6 +189,8 @@ void CountlyPrint(NSString *stringToPrint);
 - (NSDictionary *)cly_truncated:(NSString *)explanation;
 - (NSDictionary *)cly_limited:(NSString *)explanation;
 - (NSMutableDictionary *)cly_filterSupportedDataTypes;
+- (NSMutableDictionary *)cly_sanitizedSegmentation:(NSString *)explanation;
+- (void)cly_sanitizeSegmentationInto:(NSMutableDictionary *)output explanation:(NSString *)explanation reservedKeys:(NSSet<NSString *> * _Nullable)reservedKeys route:(CountlyEventRoute * _Nullable)route;
 @end
 
 @interface NSData (Countly)
@@ -181,10 +201,18 @@ void CountlyPrint(NSString *stringToPrint);
 - (void)recordReservedEvent:(NSString *)key segmentation:(NSDictionary *)segmentation;
 - (void)recordReservedEvent:(NSString *)key segmentation:(NSDictionary *)segmentation ID:(NSString *)ID;
 - (void)recordReservedEvent:(NSString *)key segmentation:(NSDictionary *)segmentation count:(NSUInteger)count sum:(double)sum duration:(NSTimeInterval)duration ID:(NSString *)ID timestamp:(NSTimeInterval)timestamp;
+- (void)recordSanitizedReservedEvent:(NSString *)key segmentation:(NSMutableDictionary *)segmentation count:(NSUInteger)count sum:(double)sum duration:(NSTimeInterval)duration ID:(NSString *)ID timestamp:(NSTimeInterval)timestamp;
 @end
 
 @interface CountlyUserDetails (ClearUserDetails)
 - (void)clearUserDetails;
 @end
 
+@interface CountlyUserDetails (AcknowledgedValues)
+- (void)userDetailsAcknowledged:(NSString *)userDetails;
+- (void)userDetailsAcknowledged:(NSString *)userDetails forDeviceID:(NSString *)deviceID;
+- (void)clearAcknowledgedValues;
+- (void)unloadAcknowledgedValues;
+@end
+
 NS_ASSUME_NONNULL_END
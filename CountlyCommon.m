@@ -18,7 +18,6 @@ NSString* const kCountlyVisibility = @"cly_v";
     NSCalendar* gregorianCalendar;
     NSTimeInterval startTime;
 }
-@property long long lastTimestamp;
 
 #if (TARGET_OS_IOS || TARGET_OS_VISION )
 @property (nonatomic) NSString* lastInterfaceOrientation;
@@ -39,8 +38,6 @@ NSString* const kCountlyInternalLogPrefix = @"[Countly] ";
 
 @implementation CountlyCommon
 
-@synthesize lastTimestamp;
-
 static CountlyCommon *s_sharedInstance = nil;
 static dispatch_once_t onceToken;
 + (instancetype)sharedInstance
@@ -56,7 +53,6 @@ static dispatch_once_t onceToken;
         gregorianCalendar = [NSCalendar.alloc initWithCalendarIdentifier:NSCalendarIdentifierGregorian];
         startTime = NSDate.date.timeIntervalSince1970;
         
-        self.lastTimestamp = 0;
         self.SDKVersion = kCountlySDKVersion;
         self.SDKName = kCountlySDKName;
     }
@@ -147,19 +143,29 @@ void CountlyPrint(NSString *stringToPrint)
 #pragma mark - Time/Date related methods
 - (NSInteger)hourOfDay
 {
-    NSDateComponents* components = [gregorianCalendar components:NSCalendarUnitHour fromDate:NSDate.date];
-    return components.hour;
+    return CountlyClock.sharedInstance.hourOfDay;
 }
 
 - (NSInteger)dayOfWeek
 {
-    NSDateComponents* components = [gregorianCalendar components:NSCalendarUnitWeekday fromDate:NSDate.date];
+    return CountlyClock.sharedInstance.dayOfWeek;
+}
+
+- (NSInteger)hourOfDayForTimestamp:(NSTimeInterval)timestamp
+{
+    NSDateComponents* components = [gregorianCalendar components:NSCalendarUnitHour fromDate:[NSDate dateWithTimeIntervalSince1970:timestamp]];
+    return components.hour;
+}
+
+- (NSInteger)dayOfWeekForTimestamp:(NSTimeInterval)timestamp
+{
+    NSDateComponents* components = [gregorianCalendar components:NSCalendarUnitWeekday fromDate:[NSDate dateWithTimeIntervalSince1970:timestamp]];
     return components.weekday - 1;
 }
 
 - (NSInteger)timeZone
 {
-    return NSTimeZone.systemTimeZone.secondsFromGMT / 60;
+    return CountlyClock.sharedInstance.timeZone;
 }
 
 - (NSInteger)timeSinceLaunch
@@ -169,26 +175,12 @@ void CountlyPrint(NSString *stringToPrint)
 
 - (NSTimeInterval)uniqueTimestamp
 {
-    long long now = floor(NSDate.date.timeIntervalSince1970 * 1000);
-
-    if (now <= self.lastTimestamp)
-        self.lastTimestamp++;
-    else
-        self.lastTimestamp = now;
-
-    return (NSTimeInterval)(self.lastTimestamp / 1000.0);
+    return (NSTimeInterval)(CountlyClock.sharedInstance.uniqueTimestampInMilliseconds / 1000.0);
 }
 
 - (NSString *)randomEventID
 {
-    const int size = 6;
-    void *randomBuffer = malloc(size);
-    arc4random_buf(randomBuffer, size);
-    NSData* randomData = [NSData dataWithBytesNoCopy:randomBuffer length:size freeWhenDone:YES];
-    NSString* randomBase64 = [randomData base64EncodedStringWithOptions:0];
-    NSTimeInterval timestamp = self.uniqueTimestamp;
-    NSString* randomEventID = [NSString stringWithFormat:@"%@%lld", randomBase64, (long long)(timestamp * 1000)];
-    return randomEventID;
+    return CountlyEventIDGenerator.sharedInstance.nextID;
 }
 
 #pragma mark - Orientation
@@ -206,8 +198,12 @@ void CountlyPrint(NSString *stringToPrint)
         return;
 
     //NOTE: Delay is needed for interface orientation change animation to complete. Otherwise old interface orientation value is returned.
-    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(recordOrientation) object:nil];
-    [self performSelector:@selector(recordOrientation) withObject:nil afterDelay:0.5];
+    //NOTE: Rescheduling the task replaces the pending one, so only the last change in a burst is recorded
+    __weak typeof(self) weakSelf = self;
+    [CountlyTimerWheel.sharedInstance scheduleTaskWithIdentifier:kCountlyTimerTaskOrientation interval:0.5 repeats:NO task:^
+    {
+        dispatch_async(dispatch_get_main_queue(), ^{ [weakSelf recordOrientation]; });
+    }];
 }
 
 - (void)recordOrientation
@@ -577,45 +573,125 @@ const CGFloat kCountlyDismissButtonStandardStatusBarHeight = 20.0;
 
 
 #pragma mark - Categories
-NSString* CountlyJSONFromObject(id object)
+NSString* CountlyURLEscapedJSONFromObject(id object)
 {
     if (!object)
         return nil;
 
-    if (![NSJSONSerialization isValidJSONObject:object])
+    CountlyJSONWriter* writer = [CountlyJSONWriter.alloc initWithMode:CLYJSONWriterModeURLEscaped];
+    if (![writer writeObject:object])
     {
         CLY_LOG_W(@"Object is not valid for converting to JSON!");
         return nil;
     }
 
-    NSError *error = nil;
-    NSData *data = [NSJSONSerialization dataWithJSONObject:object options:0 error:&error];
-    if (error)
+    return writer.string;
+}
+
+//NOTE: Finds raw (still percent-encoded) value ranges of given keys in a single pass over the query string, without allocating.
+//NOTE: Ranges of keys not found (or found without a value) are set to NSNotFound. First occurrence of a key wins.
+void CountlyQueryStringScan(NSString* queryString, __unsafe_unretained NSString* const* keys, NSRange* valueRanges, NSUInteger keyCount)
+{
+    NSUInteger remaining = keyCount;
+    for (NSUInteger k = 0; k < keyCount; k++)
     {
-        CLY_LOG_W(@"%s, JSON can not be created error:[ %@ ]", __FUNCTION__, error);
+        valueRanges[k] = NSMakeRange(NSNotFound, 0);
     }
 
-    return [data cly_stringUTF8];
+    CFStringRef string = (__bridge CFStringRef)queryString;
+    CFIndex length = string ? CFStringGetLength(string) : 0;
+    CFStringInlineBuffer buffer;
+    CFStringInitInlineBuffer(string, &buffer, CFRangeMake(0, length));
+
+    CFIndex pairStart = 0;
+    while (pairStart < length && remaining > 0)
+    {
+        CFIndex separator = kCFNotFound;
+        CFIndex i = pairStart;
+        for (; i < length; i++)
+        {
+            UniChar c = CFStringGetCharacterFromInlineBuffer(&buffer, i);
+            if (c == '&')
+                break;
+
+            if (c == '=' && separator == kCFNotFound)
+                separator = i;
+        }
+
+        if (separator != kCFNotFound)
+        {
+            CFIndex keyLength = separator - pairStart;
+            for (NSUInteger k = 0; k < keyCount; k++)
+            {
+                CFStringRef key = (__bridge CFStringRef)keys[k];
+                if (valueRanges[k].location != NSNotFound || CFStringGetLength(key) != keyLength)
+                    continue;
+
+                BOOL isMatching = YES;
+                for (CFIndex j = 0; j < keyLength && isMatching; j++)
+                {
+                    isMatching = CFStringGetCharacterFromInlineBuffer(&buffer, pairStart + j) == CFStringGetCharacterAtIndex(key, j);
+                }
+
+                if (isMatching)
+                {
+                    valueRanges[k] = NSMakeRange(separator + 1, i - separator - 1);
+                    remaining--;
+                    break;
+                }
+            }
+        }
+
+        pairStart = i + 1;
+    }
 }
 
 @implementation NSString (Countly)
 - (NSString *)cly_URLEscaped
 {
-    NSCharacterSet* charset = [NSCharacterSet characterSetWithCharactersInString:@"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-._~"];
+    static NSCharacterSet* charset = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^
+    {
+        charset = [NSCharacterSet characterSetWithCharactersInString:@"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-._~"];
+    });
+
     return [self stringByAddingPercentEncodingWithAllowedCharacters:charset];
 }
 
 - (NSString *)cly_SHA256
 {
+    return [self cly_SHA256WithSuffix:nil];
+}
+
+//NOTE: Hashes receiver and suffix as if they were concatenated, without creating the concatenated string.
+- (NSString *)cly_SHA256WithSuffix:(NSString *)suffix
+{
+    static const char hex[] = "0123456789abcdef";
+
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+
     const char* s = [self UTF8String];
+    CC_SHA256_Update(&context, s, (CC_LONG)strlen(s));
+
+    if (suffix)
+    {
+        const char* t = [suffix UTF8String];
+        CC_SHA256_Update(&context, t, (CC_LONG)strlen(t));
+    }
+
     unsigned char digest[CC_SHA256_DIGEST_LENGTH];
-    CC_SHA256(s, (CC_LONG)strlen(s), digest);
+    CC_SHA256_Final(digest, &context);
 
-    NSMutableString* hash = NSMutableString.new;
+    char hash[CC_SHA256_DIGEST_LENGTH * 2];
     for (int i = 0; i < CC_SHA256_DIGEST_LENGTH; i++)
-        [hash appendFormat:@"%02x", digest[i]];
+    {
+        hash[i * 2] = hex[digest[i] >> 4];
+        hash[i * 2 + 1] = hex[digest[i] & 0xF];
+    }
 
-    return hash;
+    return [NSString.alloc initWithBytes:hash length:sizeof(hash) encoding:NSASCIIStringEncoding];
 }
 
 - (NSData *)cly_dataUTF8
@@ -625,17 +701,49 @@ NSString* CountlyJSONFromObject(id object)
 
 - (NSString *)cly_valueForQueryStringKey:(NSString *)key
 {
-    NSString* tempURLString = [@"http://example.com/path?" stringByAppendingString:self];
-    NSURLComponents* URLComponents = [NSURLComponents componentsWithString:tempURLString];
-    for (NSURLQueryItem* queryItem in URLComponents.queryItems)
+    NSRange range = [self cly_rangeOfValueForQueryStringKey:key];
+    if (range.location == NSNotFound)
+        return nil;
+
+    NSString* value = [self substringWithRange:range];
+    if ([value rangeOfString:@"%"].location == NSNotFound)
+        return value;
+
+    return [value stringByRemovingPercentEncoding] ?: value;
+}
+
+- (NSRange)cly_rangeOfValueForQueryStringKey:(NSString *)key
+{
+    __unsafe_unretained NSString* keys[] = {key};
+    NSRange range;
+    CountlyQueryStringScan(self, keys, &range, 1);
+    return range;
+}
+
+- (long long)cly_longLongValueForQueryStringKey:(NSString *)key
+{
+    NSRange range = [self cly_rangeOfValueForQueryStringKey:key];
+    if (range.location == NSNotFound)
+        return 0;
+
+    long long value = 0;
+    BOOL isNegative = NO;
+    for (NSUInteger i = range.location; i < NSMaxRange(range); i++)
     {
-        if ([queryItem.name isEqualToString:key])
+        unichar c = [self characterAtIndex:i];
+        if (i == range.location && c == '-')
         {
-            return queryItem.value;
+            isNegative = YES;
+            continue;
         }
+
+        if (c < '0' || c > '9')
+            break;
+
+        value = value * 10 + (c - '0');
     }
 
-    return nil;
+    return isNegative ? -value : value;
 }
 
 - (NSString *)cly_truncatedKey:(NSString *)explanation
@@ -676,7 +784,7 @@ NSString* CountlyJSONFromObject(id object)
 @implementation NSArray (Countly)
 - (NSString *)cly_JSONify
 {
-    return [CountlyJSONFromObject(self) cly_URLEscaped];
+    return CountlyURLEscapedJSONFromObject(self);
 }
 
 - (NSArray *) cly_filterSupportedDataTypes {
@@ -690,12 +798,24 @@ NSString* CountlyJSONFromObject(id object)
     }
     return filteredArray.copy;
 }
+
+//NOTE: Returns the receiver itself if all elements are of supported types, to avoid allocating a filtered copy on the common path.
+- (NSArray *)cly_filterSupportedDataTypesIfNeeded
+{
+    for (id obj in self)
+    {
+        if (![obj isKindOfClass:NSNumber.class] && ![obj isKindOfClass:NSString.class])
+            return [self cly_filterSupportedDataTypes];
+    }
+
+    return self;
+}
 @end
 
 @implementation NSDictionary (Countly)
 - (NSString *)cly_JSONify
 {
-    return [CountlyJSONFromObject(self) cly_URLEscaped];
+    return CountlyURLEscapedJSONFromObject(self);
 }
 
 - (NSDictionary *)cly_truncated:(NSString *)explanation
@@ -760,6 +880,81 @@ NSString* CountlyJSONFromObject(id object)
     return filteredDictionary.mutableCopy;
 }
 
+- (NSMutableDictionary *)cly_sanitizedSegmentation:(NSString *)explanation
+{
+    NSMutableDictionary* output = [NSMutableDictionary dictionaryWithCapacity:MIN(self.count, CountlyCommon.sharedInstance.maxSegmentationValues)];
+    [self cly_sanitizeSegmentationInto:output explanation:explanation reservedKeys:nil route:nil];
+    return output;
+}
+
+//NOTE: Validates types, removes reserved and server-filtered keys, truncates keys and values and enforces segmentation values limit in a single pass.
+//NOTE: Entries are written into given output dictionary, so multiple sources can be merged without intermediate copies. Limit applies to the output.
+- (void)cly_sanitizeSegmentationInto:(NSMutableDictionary *)output explanation:(NSString *)explanation reservedKeys:(NSSet<NSString *> *)reservedKeys route:(CountlyEventRoute *)route
+{
+    CountlyCommon* common = CountlyCommon.sharedInstance;
+    NSUInteger maxKeyLength = common.maxKeyLength;
+    NSUInteger maxValueLength = common.maxValueLength;
+    NSUInteger maxSegmentationValues = common.maxSegmentationValues;
+    CountlyServerConfig* serverConfig = route.hasSegmentationFilter ? CountlyServerConfig.sharedInstance : nil;
+    NSMutableArray* excessKeys = nil;
+
+    for (NSString* key in self)
+    {
+        if (![key isKindOfClass:NSString.class])
+            continue;
+
+        if ([reservedKeys containsObject:key])
+            continue;
+
+        if (serverConfig && ![serverConfig isSegmentationKey:key allowedWithEventFilter:route.eventSegmentationFilter])
+        {
+            CLY_LOG_D(@"Filtering out segmentation key '%@' by server config segmentation filter", key);
+            continue;
+        }
+
+        id value = self[key];
+        if ([value isKindOfClass:NSString.class])
+        {
+            if (((NSString *)value).length > maxValueLength)
+            {
+                CLY_LOG_W(@"%@ value length is more than the limit (%ld)! So, it will be truncated: %@.", explanation, (long)maxValueLength, value);
+                value = [(NSString *)value substringToIndex:maxValueLength];
+            }
+        }
+        else if ([value isKindOfClass:NSArray.class])
+        {
+            value = [(NSArray *)value cly_filterSupportedDataTypesIfNeeded];
+        }
+        else if (![value isKindOfClass:NSNumber.class])
+        {
+            CLY_LOG_W(@"%s, Removed invalid type for key %@: %@", __FUNCTION__, key, [value class]);
+            continue;
+        }
+
+        NSString* outputKey = key;
+        if (key.length > maxKeyLength)
+        {
+            CLY_LOG_W(@"%@ key length is more than the limit (%ld)! So, it will be truncated: %@.", explanation, (long)maxKeyLength, key);
+            outputKey = [key substringToIndex:maxKeyLength];
+        }
+
+        if (output.count >= maxSegmentationValues && !output[outputKey])
+        {
+            if (!excessKeys)
+                excessKeys = NSMutableArray.new;
+            [excessKeys addObject:outputKey];
+            continue;
+        }
+
+        output[outputKey] = value;
+    }
+
+    if (excessKeys)
+    {
+        CLY_LOG_W(@"%s, Number of key-value pairs in %@ is more than the limit (%ld)! So, some of them will be removed %@", __FUNCTION__, explanation, (long)maxSegmentationValues, [excessKeys description]);
+    }
+}
+
 @end
 
 @implementation NSData (Countly)
@@ -126,6 +126,10 @@ typedef void (^RCVariantCallback)(CLYRequestResult response, NSError *_Nullable
 
 typedef void (^RCDownloadCallback)(CLYRequestResult response, NSError *_Nullable error, BOOL fullValueUpdate, NSDictionary<NSString *, CountlyRCData *>* downloadedValues);
 
+typedef void (^RCChangeCallback)(NSDictionary<NSString *, CountlyRCData *>* addedValues, NSDictionary<NSString *, CountlyRCData *>* changedValues, NSArray<NSString *>* removedKeys);
+
+typedef void (^RCKeyObserver)(NSString* key, CountlyRCData *_Nullable value);
+
 
 //NOTE: Internal log levels
 typedef enum : NSUInteger
@@ -161,6 +165,14 @@ typedef enum : NSUInteger
  */
 @property (nonatomic, copy) NSString* host;
 
+/**
+ * Additional Countly Server URLs serving the same application, in order of preference.
+ * @discussion Requests are sent to the fastest healthy one among @c host and these, based on measured round trip times and error rates.
+ * @discussion If a host can not be reached, it is put on a cooldown and requests fail over to the next one automatically.
+ * @discussion Queued requests are not bound to a host, they can be sent to any of them.
+ */
+@property (nonatomic, copy, nullable) NSArray<NSString *>* fallbackHosts;
+
 /**
  * Application's App Key found on Countly Server's "Management > Applications" section.
  * @discussion Using API Key or App ID will not work.
@@ -650,6 +662,14 @@ typedef enum : NSUInteger
  */
 @property (nonatomic) BOOL enrollABOnRCDownload;
 
+/**
+ * For setting how long downloaded remote config values are considered fresh, in seconds.
+ * @discussion If set, automatic downloads are skipped while cached values are fresh, and reading values after they become stale returns cached values immediately while they are refreshed in background.
+ * @discussion Refresh starts at a random point between 80% and 100% of this duration, to spread requests of many devices over time.
+ * @discussion If not set, default value is 0, meaning values never expire.
+ */
+@property (nonatomic) NSTimeInterval remoteConfigTTL;
+
 
 #pragma mark -
 
@@ -7,6 +7,8 @@
 #import <Foundation/Foundation.h>
 #import "Resettable.h"
 
+@protocol CountlyNetworkStateProvider;
+
 extern NSString* const kCountlyQSKeyAppKey;
 extern NSString* const kCountlyQSKeyDeviceID;
 extern NSString* const kCountlyQSKeyDeviceIDType;
@@ -14,6 +16,20 @@ extern NSString* const kCountlyQSKeySDKVersion;
 extern NSString* const kCountlyQSKeySDKName;
 extern NSString* const kCountlyQSKeyMethod;
 extern NSString* const kCountlyQSKeyMetrics;
+extern NSString* const kCountlyQSKeyDeviceIDOld;
+extern NSString* const kCountlyQSKeySessionBegin;
+extern NSString* const kCountlyQSKeySessionDuration;
+extern NSString* const kCountlyQSKeySessionEnd;
+extern NSString* const kCountlyQSKeyPushTokenSession;
+extern NSString* const kCountlyQSKeyLocation;
+extern NSString* const kCountlyQSKeyLocationCity;
+extern NSString* const kCountlyQSKeyLocationCountry;
+extern NSString* const kCountlyQSKeyLocationIP;
+extern NSString* const kCountlyQSKeyConsent;
+extern NSString* const kCountlyQSKeyCrash;
+extern NSString* const kCountlyQSKeyUserDetails;
+extern NSString* const kCountlyQSKeyEvents;
+extern NSString* const kCountlyQSKeyAPM;
 
 extern NSString* const kCountlyEndpointI;
 extern NSString* const kCountlyEndpointO;
@@ -30,6 +46,7 @@ extern const NSInteger kCountlyGETRequestMaxLength;
 
 @property (nonatomic) NSString* appKey;
 @property (nonatomic) NSString* host;
+@property (nonatomic, copy) NSArray<NSString *>* fallbackHosts;
 @property (nonatomic) NSURLSessionTask* connection;
 @property (nonatomic) NSArray* pinnedCertificates;
 @property (nonatomic) NSString* secretSalt;
@@ -37,6 +54,7 @@ extern const NSInteger kCountlyGETRequestMaxLength;
 @property (nonatomic) NSURLSessionConfiguration* URLSessionConfiguration;
 
 @property (nonatomic) BOOL isTerminating;
+@property (nonatomic) id<CountlyNetworkStateProvider> networkStateProvider;
 
 + (instancetype)sharedInstance;
 
@@ -44,6 +62,7 @@ extern const NSInteger kCountlyGETRequestMaxLength;
 
 - (void)beginSession;
 - (void)updateSession;
+- (void)updateSessionAndSendEvents;
 - (void)endSession;
 
 - (void)sendEventsWithSaveIfNeeded;
@@ -68,8 +87,11 @@ extern const NSInteger kCountlyGETRequestMaxLength;
 - (void)addCustomNetworkRequestHeaders:(NSDictionary<NSString *, NSString *> *_Nullable)customHeaderValues;
 
 - (void)proceedOnQueue;
+- (BOOL)shouldDeferQueue;
 
 - (NSString *)queryEssentials;
+- (NSMutableString *)mutableQueryEssentials;
+- (void)invalidateQueryEssentials;
 - (NSString *)appendChecksum:(NSString *)queryString;
 
 - (BOOL)isSessionStarted;
@@ -117,6 +139,7 @@ typedef void (^CLYQueueFlushRunnable)(void);
  * Sends pending events with an associated callback.
  * @discussion Used for Journey Trigger Events (JTE) to get notified when the events request succeeds.
  * @discussion Serializes recorded events, adds them to queue with callback, and proceeds on queue.
+ * @discussion If recorded events were already queued by an earlier flush, callback is executed once those events are delivered.
  * @param callback Block to be executed when the events request completes
  */
 - (void)sendEventsWithCallback:(CLYRequestCallback)callback;
@@ -7,6 +7,19 @@
 #import "CountlyCommon.h"
 #import <stdatomic.h>
 
+//NOTE: Invariant parts of query essentials, cached until app key, device ID or SDK name/version change.
+@interface CountlyQueryEssentialsCache : NSObject
+@property (nonatomic, copy) NSString* appKey;
+@property (nonatomic, copy) NSString* deviceID;
+@property (nonatomic, copy) NSString* SDKVersion;
+@property (nonatomic, copy) NSString* SDKName;
+@property (nonatomic, copy) NSString* prefix;
+@property (nonatomic, copy) NSString* suffix;
+@end
+
+@implementation CountlyQueryEssentialsCache
+@end
+
 @interface CountlyConnectionManager ()
 {
     NSTimeInterval unsentSessionLength;
@@ -23,6 +36,9 @@
 @property (nonatomic, strong) NSMutableArray<CLYQueueFlushRunnable> *queueFlushRunnables;
 @property (nonatomic) BOOL hasAnyRequestFailed;
 @property (nonatomic, strong) dispatch_queue_t callbackQueue; // Serial queue for thread-safe callback/runnable access
+@property (atomic, strong) CountlyQueryEssentialsCache* queryEssentialsCache;
+@property (nonatomic) NSTimeInterval deferralStartTime;
+@property (atomic, strong) CountlyHostSelector* hostSelector;
 
 @end
 
@@ -76,6 +92,7 @@ NSString* const kCountlyRCKeyABOptOut         = @"ab_opt_out";
 NSString* const kCountlyEndPointOverrideTag   = @"&new_end_point=";
 NSString* const kCountlyNewEndPoint           = @"new_end_point";
 NSString* const kCountlyCallbackID            = @"callback_id";
+NSString* const kCountlyQueueMarker           = @"queue_marker";
 
 CLYAttributionKey const CLYAttributionKeyIDFA = kCountlyQSKeyIDFA;
 CLYAttributionKey const CLYAttributionKeyADID = kCountlyQSKeyADID;
@@ -91,6 +108,10 @@ NSString* const kCountlyEndpointSurveys = @"/surveys";
 
 const NSInteger kCountlyGETRequestMaxLength = 2048;
 
+//NOTE: On metered or power constrained links, deferrable requests are sent in batches of this size, or once they waited long enough
+static const NSUInteger kCountlyConstrainedLinkBatchSize = 5;
+static const NSTimeInterval kCountlyConstrainedLinkMaxDeferral = 300.0;
+
 @implementation CountlyConnectionManager : NSObject
 
 static CountlyConnectionManager *s_sharedInstance = nil;
@@ -115,11 +136,31 @@ static dispatch_once_t onceToken;
         _queueFlushRunnables = [NSMutableArray array];
         _hasAnyRequestFailed = NO;
         _callbackQueue = dispatch_queue_create("ly.count.callbackQueue", DISPATCH_QUEUE_SERIAL);
+        self.networkStateProvider = CountlyNetworkStateMonitor.new;
     }
 
     return self;
 }
 
+- (void)setNetworkStateProvider:(id<CountlyNetworkStateProvider>)networkStateProvider
+{
+    _networkStateProvider = networkStateProvider;
+
+    if (![networkStateProvider respondsToSelector:@selector(setLinkTypeChangeHandler:)])
+        return;
+
+    //NOTE: Requests deferred while offline are sent as soon as the device is back online, instead of waiting for the next request or tick
+    __weak typeof(self) weakSelf = self;
+    networkStateProvider.linkTypeChangeHandler = ^(CLYNetworkLinkType previousLinkType, CLYNetworkLinkType linkType)
+    {
+        if (previousLinkType == CLYNetworkLinkTypeOffline && linkType != CLYNetworkLinkTypeOffline)
+        {
+            CLY_LOG_D(@"%s, Device is back online, proceeding on queue", __FUNCTION__);
+            [weakSelf proceedOnQueue];
+        }
+    };
+}
+
 
 - (BOOL)isSessionStarted {
     return isSessionStarted;
@@ -150,6 +191,61 @@ static dispatch_once_t onceToken;
     {
         _host = host;
     }
+
+    [self rebuildHostSelector];
+}
+
+//NOTE: Host is read by many features sending their own requests, so it is the configured primary host without any side effects.
+//NOTE: Only queued requests are sent to the selected host, see `proceedOnQueue`.
+- (NSString *)host
+{
+    return _host;
+}
+
+- (void)setFallbackHosts:(NSArray<NSString *> *)fallbackHosts
+{
+    _fallbackHosts = fallbackHosts.copy;
+
+    [self rebuildHostSelector];
+}
+
+- (void)rebuildHostSelector
+{
+    NSMutableArray* hosts = NSMutableArray.new;
+    if (_host.length)
+        [hosts addObject:_host];
+
+    for (NSString* fallbackHost in _fallbackHosts)
+    {
+        if (![fallbackHost isKindOfClass:NSString.class] || !fallbackHost.length)
+            continue;
+
+        NSString* host = [fallbackHost hasSuffix:@"/"] ? [fallbackHost substringToIndex:fallbackHost.length - 1] : fallbackHost;
+        if (![hosts containsObject:host])
+            [hosts addObject:host];
+    }
+
+    //NOTE: Without any fallback hosts there is nothing to select from, so the host is used directly
+    self.hostSelector = hosts.count > 1 ? [CountlyHostSelector.alloc initWithHosts:hosts] : nil;
+}
+
+- (BOOL)isHostConnectionError:(NSError *)error
+{
+    if (![error.domain isEqualToString:NSURLErrorDomain])
+        return NO;
+
+    switch (error.code)
+    {
+        case NSURLErrorTimedOut:
+        case NSURLErrorCannotFindHost:
+        case NSURLErrorCannotConnectToHost:
+        case NSURLErrorNetworkConnectionLost:
+        case NSURLErrorDNSLookupFailed:
+        case NSURLErrorSecureConnectionFailed:
+            return YES;
+        default:
+            return NO;
+    }
 }
 
 - (void)setURLSessionConfiguration:(NSURLSessionConfiguration *)URLSessionConfiguration
@@ -230,6 +326,12 @@ static dispatch_once_t onceToken;
         atomic_store(&_isProcessingQueue, NO);
         return;
     }
+
+    if ([self shouldDeferQueue])
+    {
+        atomic_store(&_isProcessingQueue, NO);
+        return;
+    }
     
     if (!self.startTime) {
         self.startTime = [NSDate date]; // Record start time only when it's not already recorded
@@ -237,7 +339,7 @@ static dispatch_once_t onceToken;
         CLY_LOG_D(@"%s, Proceeding on queue started, queued request count %lu", __FUNCTION__, [CountlyPersistency.sharedInstance remainingRequestCount]);
     }
 
-    NSString* firstItemInQueue = [CountlyPersistency.sharedInstance firstItemInQueue];
+    NSString* firstItemInQueue = [CountlyPersistency.sharedInstance nextItemInQueue];
     if (!firstItemInQueue)
     {
         // Calculate total time when the queue becomes empty
@@ -313,19 +415,45 @@ static dispatch_once_t onceToken;
             requestCallback = self.internalRequestCallbacks[callbackID];
         });
     }
-    
-    
+
+    //NOTE: Queue markers are never sent, they only execute their callback once everything queued before them is delivered
+    if ([self extractAndRemoveParameter:&queryString parameter:kCountlyQueueMarker])
+    {
+        CLY_LOG_D(@"%s, Reached queue marker with callback ID: %@", __FUNCTION__, callbackID);
+
+        if (requestCallback)
+        {
+            requestCallback(nil, YES);
+            dispatch_sync(_callbackQueue, ^{
+                [self.internalRequestCallbacks removeObjectForKey:callbackID];
+            });
+        }
+
+        [CountlyPersistency.sharedInstance removeFromQueue:firstItemInQueue];
+        [CountlyPersistency.sharedInstance saveToFile];
+
+        atomic_store(&_isProcessingQueue, NO);
+        [self proceedOnQueue];
+        return;
+    }
+
     [CountlyCommon.sharedInstance startBackgroundTask];
 
-    queryString = [self appendRemainingRequest:queryString];
-    NSMutableData* pictureUploadData = [self pictureUploadDataForQueryString:queryString];
+    NSMutableString* requestQueryString = [NSMutableString stringWithCapacity:queryString.length + 96];
+    [requestQueryString appendString:queryString];
+    [self appendRemainingRequestToQueryString:requestQueryString];
+    NSMutableData* pictureUploadData = [self pictureUploadDataForQueryString:requestQueryString];
 
     if (!pictureUploadData)
     {
-        queryString = [self appendChecksum:queryString];
+        [self appendChecksumToQueryString:requestQueryString];
     }
 
-    NSString* serverInputEndpoint = [self.host stringByAppendingString:endPoint];
+    queryString = requestQueryString;
+
+    //NOTE: Queued requests are not bound to a host, it is selected once per send and the result is reported for the same host
+    NSString* requestHost = self.hostSelector.currentHost ?: self.host;
+    NSString* serverInputEndpoint = [requestHost stringByAppendingString:endPoint];
     NSMutableURLRequest* request;
     
     if (pictureUploadData)
@@ -344,7 +472,7 @@ static dispatch_once_t onceToken;
         
         if (self.secretSalt)
         {
-            NSString* checksum = [[[queryString stringByRemovingPercentEncoding] stringByAppendingString:self.secretSalt] cly_SHA256];
+            NSString* checksum = [[queryString stringByRemovingPercentEncoding] cly_SHA256WithSuffix:self.secretSalt];
             [self addMultipart:pictureUploadData andKey:kCountlyQSKeyChecksum256 andValue:checksum];
         }
         
@@ -371,7 +499,8 @@ static dispatch_once_t onceToken;
     {
         self.connection = nil;
         NSDate *endTimeRequest = [NSDate date];
-        long duration = (long)[endTimeRequest timeIntervalSinceDate:startTimeRequest];
+        NSTimeInterval roundTripTime = [endTimeRequest timeIntervalSinceDate:startTimeRequest];
+        long duration = (long)roundTripTime;
         
         CLY_LOG_V(@"Approximate received data size for request <%p> is %ld bytes.", (id)request, (long)data.length);
         
@@ -383,10 +512,16 @@ static dispatch_once_t onceToken;
 
         if (!error)
         {
+            [self.hostSelector recordSuccessForHost:requestHost roundTripTime:roundTripTime];
+
             if ([self isRequestSuccessful:response data:data])
             {
                 CLY_LOG_D(@"Request <%p> successfully completed.", request);
 
+                NSString* acknowledgedUserDetails = [queryString cly_valueForQueryStringKey:kCountlyQSKeyUserDetails];
+                if (acknowledgedUserDetails)
+                    [CountlyUserDetails.sharedInstance userDetailsAcknowledged:acknowledgedUserDetails forDeviceID:[queryString cly_valueForQueryStringKey:kCountlyQSKeyDeviceID]];
+
                 if(requestCallback){
                     requestCallback([response description], YES);
                     // Clean up callback after execution
@@ -458,6 +593,17 @@ static dispatch_once_t onceToken;
 #endif
             self.startTime = nil;
             atomic_store(&self->_isProcessingQueue, NO);
+
+            if ([self isHostConnectionError:error])
+            {
+                [self.hostSelector recordFailureForHost:requestHost];
+
+                if ([self.hostSelector hasHealthyHostOtherThan:requestHost])
+                {
+                    CLY_LOG_D(@"%s, host [ %@ ] is unreachable, failing over to another host", __FUNCTION__, requestHost);
+                    [self proceedOnQueue];
+                }
+            }
         }
     }];
 
@@ -489,13 +635,54 @@ static dispatch_once_t onceToken;
     }
     CLY_LOG_I(@"%s final metrics:[%@]", __FUNCTION__, finalMetrics);
     
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@",
-                             kCountlyQSKeyMetrics, [finalMetrics cly_JSONify]];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@", kCountlyQSKeyMetrics, [finalMetrics cly_JSONify]];
     
     [CountlyPersistency.sharedInstance addToQueue:queryString];
     [self proceedOnQueue];
 }
 
+//NOTE: Control and crash requests are urgent and never deferred. As control requests keep ordering, anything queued before them is not deferred either.
+//NOTE: Other lanes are held while offline, and batched while on a metered link or power constrained. Unmetered links are flushed eagerly.
+- (BOOL)shouldDeferQueue
+{
+    CountlyPersistency* persistency = CountlyPersistency.sharedInstance;
+    NSUInteger queuedRequestCount = [persistency remainingRequestCount];
+    if (!queuedRequestCount || [persistency hasQueuedRequestOfClass:CLYRequestClassControl] || [persistency hasQueuedRequestOfClass:CLYRequestClassCrash])
+    {
+        self.deferralStartTime = 0;
+        return NO;
+    }
+
+    CLYNetworkLinkType linkType = [self.networkStateProvider linkType];
+    if (linkType == CLYNetworkLinkTypeOffline)
+    {
+        CLY_LOG_D(@"%s, Proceeding on queue is deferred: Device is offline!", __FUNCTION__);
+        return YES;
+    }
+
+    //NOTE: Once a batch started to be sent, it is sent until the queue is empty
+    BOOL isConstrained = linkType == CLYNetworkLinkTypeMetered || [self.networkStateProvider isPowerConstrained];
+    if (!isConstrained || self.startTime || queuedRequestCount >= kCountlyConstrainedLinkBatchSize)
+    {
+        self.deferralStartTime = 0;
+        return NO;
+    }
+
+    NSTimeInterval now = NSDate.date.timeIntervalSince1970;
+    if (!self.deferralStartTime)
+        self.deferralStartTime = now;
+
+    if (now - self.deferralStartTime >= kCountlyConstrainedLinkMaxDeferral)
+    {
+        self.deferralStartTime = 0;
+        return NO;
+    }
+
+    CLY_LOG_D(@"%s, Proceeding on queue is deferred: Link is constrained, waiting for a batch of %lu requests", __FUNCTION__, (unsigned long)kCountlyConstrainedLinkBatchSize);
+    return YES;
+}
+
 - (BOOL)backoff:(long)responseTimeSeconds queryString:(NSString *)queryString
 {
     BOOL result = NO;
@@ -507,7 +694,7 @@ static dispatch_once_t onceToken;
         
         if (remainingRequests <= threshold) {
             // Calculate the age of the current request
-            double requestTimestamp = [[queryString cly_valueForQueryStringKey:kCountlyQSKeyTimestamp] longLongValue] / 1000.0;
+            double requestTimestamp = [queryString cly_longLongValueForQueryStringKey:kCountlyQSKeyTimestamp] / 1000.0;
             double requestAgeInSeconds = [NSDate date].timeIntervalSince1970 - requestTimestamp;
             
             if (requestAgeInSeconds <= [CountlyServerConfig.sharedInstance bomRequestAge] * 3600.0) {
@@ -531,8 +718,7 @@ static dispatch_once_t onceToken;
     CLY_LOG_D(@"%s, backed off, countdown start for %f seconds", __FUNCTION__, [CountlyServerConfig.sharedInstance bomDuration]);
 
     atomic_store(&_backoff, YES);
-    dispatch_time_t delay = dispatch_time(DISPATCH_TIME_NOW, (int64_t)([CountlyServerConfig.sharedInstance bomDuration] * NSEC_PER_SEC));
-    dispatch_after(delay, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    [CountlyTimerWheel.sharedInstance scheduleTaskWithIdentifier:kCountlyTimerTaskBackoff interval:[CountlyServerConfig.sharedInstance bomDuration] repeats:NO task:^{
         __strong typeof(weakSelf) strongSelf = weakSelf;
         if (!strongSelf) return;
         
@@ -540,22 +726,29 @@ static dispatch_once_t onceToken;
         CLY_LOG_D(@"%s, countdown finished, running tick in background thread", __FUNCTION__);
         atomic_store(&strongSelf->_backoff, NO);
         [strongSelf proceedOnQueue];
-    });
+    }];
 }
 
 - (NSString*)extractAndRemoveParameter:(NSString **)queryString parameter:(NSString*)parameter
 {
     CLY_LOG_D(@"%s, Extracting parameter: %@", __FUNCTION__, parameter);
 
-    if([*queryString containsString:parameter]) {
-        NSString* parameterExtracted = [*queryString cly_valueForQueryStringKey:parameter];
-        if(parameterExtracted) {
-            NSString* stringToRemove = [NSString stringWithFormat:@"&%@=%@",parameter,parameterExtracted];
-            *queryString = [*queryString stringByReplacingOccurrencesOfString:stringToRemove withString:@""];
-            CLY_LOG_D(@"%s, Parameter extracted successfully: %@ = %@", __FUNCTION__, parameter, parameterExtracted);
-            return parameterExtracted;
-        }
-        CLY_LOG_D(@"%s, Parameter found but value extraction failed for: %@", __FUNCTION__, parameter);
+    NSRange valueRange = [*queryString cly_rangeOfValueForQueryStringKey:parameter];
+    if(valueRange.location != NSNotFound) {
+        NSString* parameterExtracted = [*queryString substringWithRange:valueRange];
+        if ([parameterExtracted rangeOfString:@"%"].location != NSNotFound)
+            parameterExtracted = [parameterExtracted stringByRemovingPercentEncoding] ?: parameterExtracted;
+
+        //NOTE: Remove the whole "&parameter=value" pair, including the leading separator when there is one
+        NSUInteger pairStart = valueRange.location - parameter.length - 1;
+        NSUInteger pairEnd = NSMaxRange(valueRange);
+        if (pairStart > 0 && [*queryString characterAtIndex:pairStart - 1] == '&')
+            pairStart--;
+        else if (pairEnd < (*queryString).length)
+            pairEnd++;
+        *queryString = [*queryString stringByReplacingCharactersInRange:NSMakeRange(pairStart, pairEnd - pairStart) withString:@""];
+        CLY_LOG_D(@"%s, Parameter extracted successfully: %@ = %@", __FUNCTION__, parameter, parameterExtracted);
+        return parameterExtracted;
     } else {
         CLY_LOG_D(@"%s, Parameter not found in query string: %@", __FUNCTION__, parameter);
     }
@@ -618,22 +811,23 @@ static dispatch_once_t onceToken;
     }
 
     isSessionStarted = YES;
-    lastSessionStartTime = NSDate.date.timeIntervalSince1970;
+    lastSessionStartTime = CountlyClock.sharedInstance.monotonicTime;
     unsentSessionLength = 0.0;
 
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@&%@=%@",
-                             kCountlyQSKeySessionBegin, @"1",
-                             kCountlyQSKeyMetrics, [CountlyDeviceInfo metrics]];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@&%@=%@",
+        kCountlyQSKeySessionBegin, @"1",
+        kCountlyQSKeyMetrics, [CountlyDeviceInfo metrics]];
 
     if(CountlyServerConfig.sharedInstance.locationTrackingEnabled) {
         NSString* locationRelatedInfoQueryString = [self locationRelatedInfoQueryString];
         if (locationRelatedInfoQueryString)
-            queryString = [queryString stringByAppendingString:locationRelatedInfoQueryString];
+            [queryString appendString:locationRelatedInfoQueryString];
     }
 
     NSString* attributionQueryString = [self attributionQueryString];
     if (attributionQueryString)
-        queryString = [queryString stringByAppendingString:attributionQueryString];
+        [queryString appendString:attributionQueryString];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString];
     
@@ -660,8 +854,38 @@ static dispatch_once_t onceToken;
         [CountlyUserDetails.sharedInstance save];
     }
 
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%d",
-                             kCountlyQSKeySessionDuration, (int)[self sessionLengthInSeconds]];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%d",
+        kCountlyQSKeySessionDuration, (int)[self sessionLengthInSeconds]];
+
+    [CountlyPersistency.sharedInstance addToQueue:queryString];
+
+    [self proceedOnQueue];
+}
+
+//NOTE: Carries session duration on the events request of the same tick, instead of sending them as two separate requests.
+//NOTE: If there are no events to send, a standalone heartbeat is queued. Persistency merges it into a pending events request carrying session duration, if there is one.
+- (void)updateSessionAndSendEvents
+{
+    BOOL canUpdateSession = CountlyConsentManager.sharedInstance.consentForSessions && CountlyServerConfig.sharedInstance.sessionTrackingEnabled && isSessionStarted;
+    if (!canUpdateSession || isCrashing || [CountlyUserDetails.sharedInstance hasUnsyncedChanges])
+    {
+        [self updateSession];
+        [self sendEventsWithSaveIfNeeded];
+        return;
+    }
+
+    NSString* events = [CountlyPersistency.sharedInstance serializedRecordedEvents];
+    if (!events)
+    {
+        [self updateSession];
+        return;
+    }
+
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@&%@=%d",
+        kCountlyQSKeyEvents, events,
+        kCountlyQSKeySessionDuration, (int)[self sessionLengthInSeconds]];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString];
 
@@ -682,9 +906,10 @@ static dispatch_once_t onceToken;
     }
 
     isSessionStarted = NO;
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@&%@=%d",
-                             kCountlyQSKeySessionEnd, @"1",
-                             kCountlyQSKeySessionDuration, (int)[self sessionLengthInSeconds]];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@&%@=%d",
+        kCountlyQSKeySessionEnd, @"1",
+        kCountlyQSKeySessionDuration, (int)[self sessionLengthInSeconds]];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString];
 
@@ -730,20 +955,30 @@ static dispatch_once_t onceToken;
     [self addEventsToQueue:nil];
 }
 
-- (void)addEventsToQueue:(CLYRequestCallback)callback
+- (BOOL)addEventsToQueue:(CLYRequestCallback)callback
 {
     NSString* events = [CountlyPersistency.sharedInstance serializedRecordedEvents];
 
     if (!events)
-        return;
+        return NO;
 
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@", kCountlyQSKeyEvents, events];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@", kCountlyQSKeyEvents, events];
     [self addToQueueWithCallback:queryString callback:callback];
+    return YES;
 }
 
 - (void)sendEventsWithCallback:(CLYRequestCallback)callback
 {
-    [self addEventsToQueue:callback];
+    if (![self addEventsToQueue:callback] && callback)
+    {
+        //NOTE: Recorded events were already queued by an earlier flush, so a marker is queued right after them instead.
+        //NOTE: It shares the events lane, so callback is executed only once those events are delivered.
+        NSMutableString* queryString = [self mutableQueryEssentials];
+        [queryString appendFormat:@"&%@=1", kCountlyQueueMarker];
+        [self addToQueueWithCallback:queryString callback:callback];
+    }
+
     [self proceedOnQueue];
 }
 
@@ -759,10 +994,11 @@ static dispatch_once_t onceToken;
     else if ([CountlyPushNotifications.sharedInstance.pushTestMode isEqualToString:CLYPushTestModeTestFlightOrAdHoc])
         testMode = 2; //NOTE: 2: TestFlight/AdHoc builds - special test mode using Production APNs
 
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@&%@=%@&%@=%ld",
-                             kCountlyQSKeyPushTokenSession, @"1",
-                             kCountlyQSKeyPushTokeniOS, token,
-                             kCountlyQSKeyPushTestMode, (long)testMode];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@&%@=%@&%@=%ld",
+        kCountlyQSKeyPushTokenSession, @"1",
+        kCountlyQSKeyPushTokeniOS, token,
+        kCountlyQSKeyPushTestMode, (long)testMode];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString];
 
@@ -777,7 +1013,8 @@ static dispatch_once_t onceToken;
     if (!locationRelatedInfoQueryString)
         return;
 
-    NSString* queryString = [[self queryEssentials] stringByAppendingString:locationRelatedInfoQueryString];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendString:locationRelatedInfoQueryString];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString];
 
@@ -786,8 +1023,9 @@ static dispatch_once_t onceToken;
 
 - (void)sendUserDetails:(NSString *)userDetails
 {
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@",
-                             kCountlyQSKeyUserDetails, userDetails];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@",
+        kCountlyQSKeyUserDetails, userDetails];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString];
 
@@ -808,8 +1046,9 @@ static dispatch_once_t onceToken;
         return;
     }
 
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@",
-                             kCountlyQSKeyCrash, report];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@",
+        kCountlyQSKeyCrash, report];
 
     if (!immediately)
     {
@@ -826,24 +1065,24 @@ static dispatch_once_t onceToken;
     if (!CountlyCommon.sharedInstance.manualSessionHandling)
         [self endSession];
 
+    //NOTE: Crash report is stored in its lane before sending, so a single write persists it along with pending events and session end,
+    //NOTE: and it is not lost if the process dies while sending it.
+    [CountlyPersistency.sharedInstance addToQueue:queryString.copy];
+    [CountlyPersistency.sharedInstance saveToFileSync];
+
     if (CountlyDeviceInfo.sharedInstance.isDeviceIDTemporary)
     {
         CLY_LOG_D(@"Device ID is set as CLYTemporaryDeviceID! Crash report stored to be sent later!");
-
-        [CountlyPersistency.sharedInstance addToQueue:queryString];
-        [CountlyPersistency.sharedInstance saveToFileSync];
         return;
     }
 
-    [CountlyPersistency.sharedInstance saveToFileSync];
+    //NOTE: Queue stores the request with app version appended, so the same string is sent and then removed from queue
+    NSString* queuedQueryString = [queryString stringByAppendingFormat:@"&%@=%@", kCountlyAppVersionKey, CountlyDeviceInfo.appVersion];
 
-    queryString = [queryString stringByAppendingFormat:@"&%@=%@",
-                   kCountlyAppVersionKey, CountlyDeviceInfo.appVersion];
-    
     NSString* serverInputEndpoint = [self.host stringByAppendingString:kCountlyEndpointI];
     NSMutableURLRequest* request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:serverInputEndpoint]];
     request.HTTPMethod = @"POST";
-    request.HTTPBody = [[self appendChecksum:queryString] cly_dataUTF8];
+    request.HTTPBody = [[self appendChecksum:queuedQueryString] cly_dataUTF8];
 
     dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
 
@@ -852,12 +1091,12 @@ static dispatch_once_t onceToken;
         if (error || ![self isRequestSuccessful:response data:data])
         {
             CLY_LOG_D(@"%s, request: [ %p ] failed! %@: %@", __FUNCTION__, request, error ? @"Error" : @"Server reply", error ?: [data cly_stringUTF8]);
-            [CountlyPersistency.sharedInstance addToQueue:queryString];
-            [CountlyPersistency.sharedInstance saveToFileSync];
         }
         else
         {
             CLY_LOG_D(@"Request <%p> successfully completed.", request);
+            [CountlyPersistency.sharedInstance removeFromQueue:queuedQueryString];
+            [CountlyPersistency.sharedInstance saveToFileSync];
         }
 
         dispatch_semaphore_signal(semaphore);
@@ -871,8 +1110,9 @@ static dispatch_once_t onceToken;
 
 - (void)sendOldDeviceID:(NSString *)oldDeviceID
 {
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@",
-                             kCountlyQSKeyDeviceIDOld, oldDeviceID.cly_URLEscaped];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@",
+        kCountlyQSKeyDeviceIDOld, oldDeviceID.cly_URLEscaped];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString];
 
@@ -885,7 +1125,8 @@ static dispatch_once_t onceToken;
     if (!attributionQueryString)
         return;
 
-    NSString* queryString = [[self queryEssentials] stringByAppendingString:attributionQueryString];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendString:attributionQueryString];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString];
 
@@ -894,7 +1135,7 @@ static dispatch_once_t onceToken;
 
 - (void)sendDirectAttributionWithCampaignID:(NSString *)campaignID andCampaignUserID:(NSString *)campaignUserID
 {
-    NSMutableString* queryString = [self queryEssentials].mutableCopy;
+    NSMutableString* queryString = [self mutableQueryEssentials];
     [queryString appendFormat:@"&%@=%@", kCountlyQSKeyCampaignID, campaignID];
 
     if (campaignUserID.length)
@@ -909,7 +1150,7 @@ static dispatch_once_t onceToken;
 
 - (void)sendAttributionData:(NSString *)attributionData
 {
-    NSMutableString* queryString = [self queryEssentials].mutableCopy;
+    NSMutableString* queryString = [self mutableQueryEssentials];
     [queryString appendFormat:@"&%@=%@", kCountlyQSKeyAttributionData, [attributionData cly_URLEscaped]];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString.copy];
@@ -919,7 +1160,7 @@ static dispatch_once_t onceToken;
 
 - (void)sendIndirectAttribution:(NSDictionary *)attribution
 {
-    NSMutableString* queryString = [self queryEssentials].mutableCopy;
+    NSMutableString* queryString = [self mutableQueryEssentials];
     [queryString appendFormat:@"&%@=%@", kCountlyQSKeyAttributionID, [attribution cly_JSONify]];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString.copy];
@@ -929,8 +1170,9 @@ static dispatch_once_t onceToken;
 
 - (void)sendConsents:(NSString *)consents
 {
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@",
-                             kCountlyQSKeyConsent, consents];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@",
+        kCountlyQSKeyConsent, consents];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString];
 
@@ -939,8 +1181,9 @@ static dispatch_once_t onceToken;
 
 - (void)sendPerformanceMonitoringTrace:(NSString *)trace
 {
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@",
-                             kCountlyQSKeyAPM, trace];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@",
+        kCountlyQSKeyAPM, trace];
 
     [CountlyPersistency.sharedInstance addToQueue:queryString];
 
@@ -951,14 +1194,15 @@ static dispatch_once_t onceToken;
 
 - (void)sendEnrollABRequestForKeys:(NSArray*)keys
 {
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@", kCountlyQSKeyMethod, kCountlyRCKeyABOptIn];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@", kCountlyQSKeyMethod, kCountlyRCKeyABOptIn];
     
     if (keys)
     {
-        queryString = [queryString stringByAppendingFormat:@"&%@=%@", kCountlyRCKeyKeys, [keys cly_JSONify]];
+        [queryString appendFormat:@"&%@=%@", kCountlyRCKeyKeys, [keys cly_JSONify]];
     }
     
-    queryString = [queryString stringByAppendingFormat:@"%@%@%@", kCountlyEndPointOverrideTag, kCountlyEndpointO, kCountlyEndpointSDK];
+    [queryString appendFormat:@"%@%@%@", kCountlyEndPointOverrideTag, kCountlyEndpointO, kCountlyEndpointSDK];
     
     [CountlyPersistency.sharedInstance addToQueue:queryString];
     
@@ -967,11 +1211,12 @@ static dispatch_once_t onceToken;
 
 - (void)sendExitABRequestForKeys:(NSArray*)keys
 {
-    NSString* queryString = [[self queryEssentials] stringByAppendingFormat:@"&%@=%@", kCountlyQSKeyMethod, kCountlyRCKeyABOptOut];
+    NSMutableString* queryString = [self mutableQueryEssentials];
+    [queryString appendFormat:@"&%@=%@", kCountlyQSKeyMethod, kCountlyRCKeyABOptOut];
     
     if (keys)
     {
-        queryString = [queryString stringByAppendingFormat:@"&%@=%@", kCountlyRCKeyKeys, [keys cly_JSONify]];
+        [queryString appendFormat:@"&%@=%@", kCountlyRCKeyKeys, [keys cly_JSONify]];
     }   
     
     [CountlyPersistency.sharedInstance addToQueue:queryString];
@@ -998,7 +1243,7 @@ static dispatch_once_t onceToken;
     }
     
     mutableRequestParameters[@"dr"] = [NSNumber numberWithInt:1];
-    NSMutableString* queryString = [self queryEssentials].mutableCopy;
+    NSMutableString* queryString = [self mutableQueryEssentials];
 
     [mutableRequestParameters enumerateKeysAndObjectsUsingBlock:^(NSString * key, NSString * value, BOOL * stop)
     {
@@ -1014,16 +1259,63 @@ static dispatch_once_t onceToken;
 
 - (NSString *)queryEssentials
 {
-    return [NSString stringWithFormat:@"%@=%@&%@=%@&%@=%d&%@=%lld&%@=%d&%@=%d&%@=%d&%@=%@&%@=%@",
-        kCountlyQSKeyAppKey, self.appKey.cly_URLEscaped,
-        kCountlyQSKeyDeviceID, CountlyDeviceInfo.sharedInstance.deviceID.cly_URLEscaped,
-        kCountlyQSKeyDeviceIDType, (int)CountlyDeviceInfo.sharedInstance.deviceIDTypeValue,
-        kCountlyQSKeyTimestamp, (long long)(CountlyCommon.sharedInstance.uniqueTimestamp * 1000),
-        kCountlyQSKeyTimeHourOfDay, (int)CountlyCommon.sharedInstance.hourOfDay,
-        kCountlyQSKeyTimeDayOfWeek, (int)CountlyCommon.sharedInstance.dayOfWeek,
-        kCountlyQSKeyTimeZone, (int)CountlyCommon.sharedInstance.timeZone,
-        kCountlyQSKeySDKVersion, CountlyCommon.sharedInstance.SDKVersion,
-        kCountlyQSKeySDKName, CountlyCommon.sharedInstance.SDKName];
+    return [self mutableQueryEssentials];
+}
+
+- (NSMutableString *)mutableQueryEssentials
+{
+    CountlyQueryEssentialsCache* cache = [self currentQueryEssentialsCache];
+    CountlyCommon* common = CountlyCommon.sharedInstance;
+
+    NSMutableString* queryString = [NSMutableString stringWithCapacity:cache.prefix.length + cache.suffix.length + 96];
+    [queryString appendString:cache.prefix];
+    [queryString appendFormat:@"&%@=%lld&%@=%d&%@=%d&%@=%d",
+        kCountlyQSKeyTimestamp, (long long)(common.uniqueTimestamp * 1000),
+        kCountlyQSKeyTimeHourOfDay, (int)common.hourOfDay,
+        kCountlyQSKeyTimeDayOfWeek, (int)common.dayOfWeek,
+        kCountlyQSKeyTimeZone, (int)common.timeZone];
+    [queryString appendString:cache.suffix];
+
+    return queryString;
+}
+
+- (CountlyQueryEssentialsCache *)currentQueryEssentialsCache
+{
+    NSString* appKey = self.appKey;
+    NSString* deviceID = CountlyDeviceInfo.sharedInstance.deviceID;
+    NSString* SDKVersion = CountlyCommon.sharedInstance.SDKVersion;
+    NSString* SDKName = CountlyCommon.sharedInstance.SDKName;
+
+    CountlyQueryEssentialsCache* cache = self.queryEssentialsCache;
+    if (cache &&
+        (cache.appKey == appKey || [cache.appKey isEqualToString:appKey]) &&
+        (cache.deviceID == deviceID || [cache.deviceID isEqualToString:deviceID]) &&
+        (cache.SDKVersion == SDKVersion || [cache.SDKVersion isEqualToString:SDKVersion]) &&
+        (cache.SDKName == SDKName || [cache.SDKName isEqualToString:SDKName]))
+    {
+        return cache;
+    }
+
+    cache = CountlyQueryEssentialsCache.new;
+    cache.appKey = appKey;
+    cache.deviceID = deviceID;
+    cache.SDKVersion = SDKVersion;
+    cache.SDKName = SDKName;
+    cache.prefix = [NSString stringWithFormat:@"%@=%@&%@=%@&%@=%d",
+        kCountlyQSKeyAppKey, appKey.cly_URLEscaped,
+        kCountlyQSKeyDeviceID, deviceID.cly_URLEscaped,
+        kCountlyQSKeyDeviceIDType, (int)CountlyDeviceInfo.sharedInstance.deviceIDTypeValue];
+    cache.suffix = [NSString stringWithFormat:@"&%@=%@&%@=%@",
+        kCountlyQSKeySDKVersion, SDKVersion,
+        kCountlyQSKeySDKName, SDKName];
+
+    self.queryEssentialsCache = cache;
+    return cache;
+}
+
+- (void)invalidateQueryEssentials
+{
+    self.queryEssentialsCache = nil;
 }
 
 
@@ -1167,19 +1459,31 @@ static dispatch_once_t onceToken;
 {
     if (self.secretSalt)
     {
-        NSString* checksum = [[queryString stringByAppendingString:self.secretSalt] cly_SHA256];
-        return [queryString stringByAppendingFormat:@"&%@=%@", kCountlyQSKeyChecksum256, checksum];
+        NSMutableString* signedQueryString = [NSMutableString stringWithCapacity:queryString.length + 80];
+        [signedQueryString appendString:queryString];
+        [self appendChecksumToQueryString:signedQueryString];
+        return signedQueryString;
     }
 
     return queryString;
 }
 
-- (NSString *)appendRemainingRequest:(NSString *)queryString
+- (void)appendChecksumToQueryString:(NSMutableString *)queryString
+{
+    if (!self.secretSalt)
+        return;
+
+    NSString* checksum = [queryString cly_SHA256WithSuffix:self.secretSalt];
+    [queryString appendString:@"&"];
+    [queryString appendString:kCountlyQSKeyChecksum256];
+    [queryString appendString:@"="];
+    [queryString appendString:checksum];
+}
+
+- (void)appendRemainingRequestToQueryString:(NSMutableString *)queryString
 {
     NSUInteger rrCount = [CountlyPersistency.sharedInstance remainingRequestCount] - 1;
-    return [queryString stringByAppendingFormat:@"&%@=%lu", kCountlyQSKeyRemainingRequest, (unsigned long)rrCount];
-    
-    return queryString;
+    [queryString appendFormat:@"&%@=%lu", kCountlyQSKeyRemainingRequest, (unsigned long)rrCount];
 }
 
 - (BOOL)isRequestSuccessful:(NSURLResponse *)response data:(NSData *)data 
@@ -1221,7 +1525,7 @@ static dispatch_once_t onceToken;
 
 - (NSInteger)sessionLengthInSeconds
 {
-    NSTimeInterval currentTime = NSDate.date.timeIntervalSince1970;
+    NSTimeInterval currentTime = CountlyClock.sharedInstance.monotonicTime;
     unsentSessionLength += (currentTime - lastSessionStartTime);
     lastSessionStartTime = currentTime;
     int sessionLengthInSeconds = (int)unsentSessionLength;
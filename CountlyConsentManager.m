@@ -61,6 +61,12 @@ static dispatch_once_t onceToken;
     return self;
 }
 
+- (void)setRequiresConsent:(BOOL)requiresConsent
+{
+    _requiresConsent = requiresConsent;
+    [CountlyEventRouter.sharedInstance invalidate];
+}
+
 - (void)resetInstance {
     CLY_LOG_I(@"%s", __FUNCTION__);
     [self cancelConsentForAllFeatures];
@@ -268,6 +274,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForSessions:(BOOL)consentForSessions
 {
     _consentForSessions = consentForSessions;
+    [CountlyEventRouter.sharedInstance invalidate];
 
     if (consentForSessions)
     {
@@ -286,6 +293,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForEvents:(BOOL)consentForEvents
 {
     _consentForEvents = consentForEvents;
+    [CountlyEventRouter.sharedInstance invalidate];
 
     if (consentForEvents)
     {
@@ -304,6 +312,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForUserDetails:(BOOL)consentForUserDetails
 {
     _consentForUserDetails = consentForUserDetails;
+    [CountlyEventRouter.sharedInstance invalidate];
 
     if (consentForUserDetails)
     {
@@ -323,6 +332,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForCrashReporting:(BOOL)consentForCrashReporting
 {
     _consentForCrashReporting = consentForCrashReporting;
+    [CountlyEventRouter.sharedInstance invalidate];
 
     if (consentForCrashReporting)
     {
@@ -342,6 +352,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForPushNotifications:(BOOL)consentForPushNotifications
 {
     _consentForPushNotifications = consentForPushNotifications;
+    [CountlyEventRouter.sharedInstance invalidate];
 
 #if (TARGET_OS_IOS || TARGET_OS_VISION || TARGET_OS_OSX)
     if (consentForPushNotifications)
@@ -366,6 +377,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForLocation:(BOOL)consentForLocation
 {
     _consentForLocation = consentForLocation;
+    [CountlyEventRouter.sharedInstance invalidate];
 
     if (consentForLocation)
     {
@@ -385,6 +397,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForViewTracking:(BOOL)consentForViewTracking
 {
     _consentForViewTracking = consentForViewTracking;
+    [CountlyEventRouter.sharedInstance invalidate];
 
 #if (TARGET_OS_IOS || TARGET_OS_VISION || TARGET_OS_TV)
     if (consentForViewTracking)
@@ -406,6 +419,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForAttribution:(BOOL)consentForAttribution
 {
     _consentForAttribution = consentForAttribution;
+    [CountlyEventRouter.sharedInstance invalidate];
 
     if (consentForAttribution)
     {
@@ -423,6 +437,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForPerformanceMonitoring:(BOOL)consentForPerformanceMonitoring
 {
     _consentForPerformanceMonitoring = consentForPerformanceMonitoring;
+    [CountlyEventRouter.sharedInstance invalidate];
 
 #if (TARGET_OS_IOS || TARGET_OS_VISION)
     if (consentForPerformanceMonitoring)
@@ -443,6 +458,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForFeedback:(BOOL)consentForFeedback
 {
     _consentForFeedback = consentForFeedback;
+    [CountlyEventRouter.sharedInstance invalidate];
 
 #if (TARGET_OS_IOS)
     if (consentForFeedback)
@@ -461,6 +477,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForRemoteConfig:(BOOL)consentForRemoteConfig
 {
     _consentForRemoteConfig = consentForRemoteConfig;
+    [CountlyEventRouter.sharedInstance invalidate];
 
     if (consentForRemoteConfig)
     {
@@ -477,6 +494,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForMetrics:(BOOL)consentForMetrics
 {
     _consentForMetrics = consentForMetrics;
+    [CountlyEventRouter.sharedInstance invalidate];
 
     if (consentForMetrics)
     {
@@ -491,6 +509,7 @@ static dispatch_once_t onceToken;
 - (void)setConsentForContent:(BOOL)consentForContent
 {
     _consentForContent = consentForContent;
+    [CountlyEventRouter.sharedInstance invalidate];
     
     if (consentForContent)
     {
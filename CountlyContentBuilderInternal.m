@@ -13,8 +13,6 @@ NSString* const kCountlyCBFetchContent  = @"queue";
 @implementation CountlyContentBuilderInternal {
     BOOL _isRequestQueueLocked;
     BOOL _isCurrentlyContentShown;
-    NSTimer *_requestTimer;
-    NSTimer *_minuteTimer;
     dispatch_queue_t _contentQueue;
 }
 
@@ -33,7 +31,6 @@ NSString* const kCountlyCBFetchContent  = @"queue";
     if (self = [super init])
     {
         self.zoneTimerInterval = 30.0;
-        _requestTimer = nil;
         _isCurrentlyContentShown = NO;
         _contentQueue = dispatch_queue_create("ly.countly.content.queue", DISPATCH_QUEUE_SERIAL);
         _contentInitialDelay = 4;
@@ -79,13 +76,12 @@ NSString* const kCountlyCBFetchContent  = @"queue";
         return;
     }
     
-    [_minuteTimer invalidate];
-    _minuteTimer = nil;
+    [CountlyTimerWheel.sharedInstance cancelTaskWithIdentifier:kCountlyTimerTaskContentZoneReenter];
     
     if (!CountlyConsentManager.sharedInstance.consentForContent)
         return;
     
-    if(_requestTimer != nil) {
+    if([CountlyTimerWheel.sharedInstance hasTaskWithIdentifier:kCountlyTimerTaskContentZone]) {
         CLY_LOG_I(@"%s already entered for content zone, please exit from content zone first to start again", __FUNCTION__);
         return;
     }
@@ -100,11 +96,11 @@ NSString* const kCountlyCBFetchContent  = @"queue";
     dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(contentDelay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^
     {
         [self fetchContents];;
-        self->_requestTimer = [NSTimer scheduledTimerWithTimeInterval:self->_zoneTimerInterval
-                                                         target:self
-                                                       selector:@selector(fetchContents)
-                                                       userInfo:nil
-                                                        repeats:YES];
+        [CountlyTimerWheel.sharedInstance scheduleTaskWithIdentifier:kCountlyTimerTaskContentZone interval:self->_zoneTimerInterval repeats:YES task:^
+        {
+            //NOTE: Content request needs window size and interface orientation, which are only available on main thread
+            dispatch_async(dispatch_get_main_queue(), ^{ [self fetchContents]; });
+        }];
     });
 }
 
@@ -178,11 +174,8 @@ NSString* const kCountlyCBFetchContent  = @"queue";
 #pragma mark - Private Methods
 
 - (void)clearContentState {
-    [_requestTimer invalidate];
-    _requestTimer = nil;
-
-    [_minuteTimer invalidate];
-    _minuteTimer = nil;
+    [CountlyTimerWheel.sharedInstance cancelTaskWithIdentifier:kCountlyTimerTaskContentZone];
+    [CountlyTimerWheel.sharedInstance cancelTaskWithIdentifier:kCountlyTimerTaskContentZoneReenter];
     self.currentTags = nil;
     [self setRequestQueueLockedThreadSafe:NO];
 }
@@ -353,11 +346,10 @@ NSString* const kCountlyCBFetchContent  = @"queue";
              {
                 CLY_LOG_I(@"%s webview dismissed", __FUNCTION__);
                 self->_isCurrentlyContentShown = NO;
-                self->_minuteTimer = [NSTimer scheduledTimerWithTimeInterval:self->_zoneTimerInterval
-                                                                 target:self
-                                                               selector:@selector(enterContentZone)
-                                                               userInfo:nil
-                                                                repeats:NO];
+                [CountlyTimerWheel.sharedInstance scheduleTaskWithIdentifier:kCountlyTimerTaskContentZoneReenter interval:self->_zoneTimerInterval repeats:NO task:^
+                {
+                    dispatch_async(dispatch_get_main_queue(), ^{ [self enterContentZone]; });
+                }];
                 if(self.contentCallback) {
                     self.contentCallback(CLOSED, NSDictionary.new);
                 }
@@ -6,6 +6,13 @@
 
 #import <Foundation/Foundation.h>
 
+extern NSString* const kCountlyEventKeyKey;
+extern NSString* const kCountlyEventKeySegmentation;
+extern NSString* const kCountlyEventKeyCount;
+extern NSString* const kCountlyEventKeySum;
+extern NSString* const kCountlyEventKeyTimestamp;
+extern NSString* const kCountlyEventKeyDuration;
+
 @interface CountlyEvent : NSObject <NSCoding>
 
 @property (nonatomic, copy) NSString* key;
@@ -20,6 +27,7 @@
 @property (nonatomic) NSUInteger hourOfDay;
 @property (nonatomic) NSUInteger dayOfWeek;
 @property (nonatomic) NSTimeInterval duration;
+@property (nonatomic) NSTimeInterval monotonicStartTime; //NOTE: Only used for measuring timed event durations, not persisted
 - (NSDictionary *)dictionaryRepresentation;
 
 @end
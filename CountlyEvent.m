@@ -22,10 +22,10 @@ NSString* const kCountlyEventKeyDayOfWeek     = @"dow";
 NSString* const kCountlyEventKeyDuration      = @"dur";
 
 /** 
-* This function is a critical component used within the `CountlyPersistency.serializeRecordedEvents` method. 
+* This function defines the event format written by `CountlyEventArena.serializedEvents` method. 
 * 
 * Note: If this function is modified, ensure that corresponding updates are made to 
-* the `CountlyPersistency.serializeRecordedEvents` method to maintain consistency and prevent potential issues. 
+* the `CountlyEventArena.serializedEvents` method to maintain consistency and prevent potential issues. 
 * 
 * @warning Changes to this function may have downstream effects. Proceed with caution. 
 */
@@ -0,0 +1,33 @@
+// CountlyEventArena.h
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import <Foundation/Foundation.h>
+
+@class CountlyEvent;
+@class CountlyJSONWriter;
+
+NS_ASSUME_NONNULL_BEGIN
+
+//NOTE: Compact storage for recorded events waiting to be sent.
+//NOTE: Event keys, IDs, segmentation keys and string values are interned into a shared string pool,
+//NOTE: and numeric fields are kept in fixed-width columns, instead of keeping a CountlyEvent object per event.
+//NOTE: Not thread-safe, callers are expected to synchronize access.
+@interface CountlyEventArena : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+
+- (void)appendEvent:(CountlyEvent *)event;
+- (void)appendEvents:(NSArray<CountlyEvent *> *)events;
+
+- (NSMutableArray<CountlyEvent *> *)events;
+- (NSData * _Nullable)serializedEvents;
+- (void)writeEventsWithWriter:(CountlyJSONWriter *)writer;
+
+- (void)removeAllEvents;
+
+@end
+
+NS_ASSUME_NONNULL_END
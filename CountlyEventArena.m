@@ -0,0 +1,341 @@
+// CountlyEventArena.m
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import "CountlyCommon.h"
+
+static const uint32_t kCountlyArenaNone = UINT32_MAX;
+static const NSUInteger kCountlyArenaInitialCapacity = 32;
+static const NSUInteger kCountlyArenaRetainedCapacityLimit = 1024;
+
+typedef NS_ENUM(uint8_t, CountlyArenaValueType)
+{
+    CountlyArenaValueTypeString,
+    CountlyArenaValueTypeObject,
+};
+
+typedef struct
+{
+    uint32_t key;
+    uint32_t value;
+    CountlyArenaValueType type;
+} CountlyArenaSegment;
+
+@interface CountlyEventArena ()
+{
+    NSUInteger _capacity;
+
+    uint32_t* _keys;
+    uint32_t* _IDs;
+    uint32_t* _CVIDs;
+    uint32_t* _PVIDs;
+    uint32_t* _PEIDs;
+    uint32_t* _segmentationStarts;
+    uint32_t* _segmentationCounts;
+    NSUInteger* _counts;
+    double* _sums;
+    double* _timestamps;
+    double* _durations;
+    uint8_t* _hoursOfDay;
+    uint8_t* _daysOfWeek;
+
+    CountlyArenaSegment* _segments;
+    NSUInteger _segmentCount;
+    NSUInteger _segmentCapacity;
+}
+@property (nonatomic, readwrite) NSUInteger count;
+@property (nonatomic) NSMutableArray<NSString *>* strings;
+@property (nonatomic) NSMutableDictionary<NSString *, NSNumber *>* stringIndices;
+@property (nonatomic) NSMutableArray* objects;
+@end
+
+
+static void CountlyArenaGrow(void** column, NSUInteger elementSize, NSUInteger capacity)
+{
+    void* grown = realloc(*column, elementSize * capacity);
+    if (!grown)
+    {
+        [NSException raise:NSMallocException format:@"Event arena can not grow to %lu elements", (unsigned long)capacity];
+    }
+    *column = grown;
+}
+
+@implementation CountlyEventArena
+
+- (instancetype)init
+{
+    if (self = [super init])
+    {
+        self.strings = NSMutableArray.new;
+        self.stringIndices = NSMutableDictionary.new;
+        self.objects = NSMutableArray.new;
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [self freeColumns];
+}
+
+- (void)freeColumns
+{
+    free(_keys); _keys = NULL;
+    free(_IDs); _IDs = NULL;
+    free(_CVIDs); _CVIDs = NULL;
+    free(_PVIDs); _PVIDs = NULL;
+    free(_PEIDs); _PEIDs = NULL;
+    free(_segmentationStarts); _segmentationStarts = NULL;
+    free(_segmentationCounts); _segmentationCounts = NULL;
+    free(_counts); _counts = NULL;
+    free(_sums); _sums = NULL;
+    free(_timestamps); _timestamps = NULL;
+    free(_durations); _durations = NULL;
+    free(_hoursOfDay); _hoursOfDay = NULL;
+    free(_daysOfWeek); _daysOfWeek = NULL;
+    free(_segments); _segments = NULL;
+
+    _capacity = 0;
+    _segmentCapacity = 0;
+}
+
+- (void)reserveCapacity:(NSUInteger)capacity
+{
+    if (capacity <= _capacity)
+        return;
+
+    NSUInteger newCapacity = MAX(MAX(_capacity * 2, kCountlyArenaInitialCapacity), capacity);
+
+    CountlyArenaGrow((void **)&_keys, sizeof(uint32_t), newCapacity);
+    CountlyArenaGrow((void **)&_IDs, sizeof(uint32_t), newCapacity);
+    CountlyArenaGrow((void **)&_CVIDs, sizeof(uint32_t), newCapacity);
+    CountlyArenaGrow((void **)&_PVIDs, sizeof(uint32_t), newCapacity);
+    CountlyArenaGrow((void **)&_PEIDs, sizeof(uint32_t), newCapacity);
+    CountlyArenaGrow((void **)&_segmentationStarts, sizeof(uint32_t), newCapacity);
+    CountlyArenaGrow((void **)&_segmentationCounts, sizeof(uint32_t), newCapacity);
+    CountlyArenaGrow((void **)&_counts, sizeof(NSUInteger), newCapacity);
+    CountlyArenaGrow((void **)&_sums, sizeof(double), newCapacity);
+    CountlyArenaGrow((void **)&_timestamps, sizeof(double), newCapacity);
+    CountlyArenaGrow((void **)&_durations, sizeof(double), newCapacity);
+    CountlyArenaGrow((void **)&_hoursOfDay, sizeof(uint8_t), newCapacity);
+    CountlyArenaGrow((void **)&_daysOfWeek, sizeof(uint8_t), newCapacity);
+
+    _capacity = newCapacity;
+}
+
+- (void)reserveSegmentCapacity:(NSUInteger)capacity
+{
+    if (capacity <= _segmentCapacity)
+        return;
+
+    NSUInteger newCapacity = MAX(MAX(_segmentCapacity * 2, kCountlyArenaInitialCapacity * 4), capacity);
+    CountlyArenaGrow((void **)&_segments, sizeof(CountlyArenaSegment), newCapacity);
+    _segmentCapacity = newCapacity;
+}
+
+- (uint32_t)internString:(NSString *)string
+{
+    if (!string)
+        return kCountlyArenaNone;
+
+    NSNumber* index = self.stringIndices[string];
+    if (index)
+        return index.unsignedIntValue;
+
+    uint32_t newIndex = (uint32_t)self.strings.count;
+    string = string.copy;
+    [self.strings addObject:string];
+    self.stringIndices[string] = @(newIndex);
+    return newIndex;
+}
+
+- (NSString *)stringAtIndex:(uint32_t)index
+{
+    return index == kCountlyArenaNone ? nil : self.strings[index];
+}
+
+#pragma mark ---
+
+- (void)appendEvent:(CountlyEvent *)event
+{
+    [self reserveCapacity:self.count + 1];
+
+    NSUInteger i = self.count;
+    _keys[i] = [self internString:event.key];
+    _IDs[i] = [self internString:event.ID];
+    _CVIDs[i] = [self internString:event.CVID];
+    _PVIDs[i] = [self internString:event.PVID];
+    _PEIDs[i] = [self internString:event.PEID];
+    _counts[i] = event.count;
+    _sums[i] = event.sum;
+    _timestamps[i] = event.timestamp;
+    _durations[i] = event.duration;
+    _hoursOfDay[i] = (uint8_t)event.hourOfDay;
+    _daysOfWeek[i] = (uint8_t)event.dayOfWeek;
+
+    NSDictionary* segmentation = event.segmentation;
+    _segmentationStarts[i] = segmentation ? (uint32_t)_segmentCount : kCountlyArenaNone;
+    _segmentationCounts[i] = (uint32_t)segmentation.count;
+
+    if (segmentation.count)
+    {
+        [self reserveSegmentCapacity:_segmentCount + segmentation.count];
+        [segmentation enumerateKeysAndObjectsUsingBlock:^(NSString* key, id value, BOOL * stop)
+        {
+            CountlyArenaSegment* segment = &self->_segments[self->_segmentCount++];
+            segment->key = [self internString:key];
+            if ([value isKindOfClass:NSString.class])
+            {
+                segment->type = CountlyArenaValueTypeString;
+                segment->value = [self internString:value];
+            }
+            else
+            {
+                //NOTE: Numbers are not interned, as NSNumber equality does not distinguish booleans from integers
+                segment->type = CountlyArenaValueTypeObject;
+                segment->value = (uint32_t)self.objects.count;
+                [self.objects addObject:value];
+            }
+        }];
+    }
+
+    self.count = i + 1;
+}
+
+- (void)appendEvents:(NSArray<CountlyEvent *> *)events
+{
+    [self reserveCapacity:self.count + events.count];
+
+    for (CountlyEvent* event in events)
+    {
+        [self appendEvent:event];
+    }
+}
+
+- (id)segmentValue:(CountlyArenaSegment)segment
+{
+    return segment.type == CountlyArenaValueTypeString ? self.strings[segment.value] : self.objects[segment.value];
+}
+
+- (NSMutableArray<CountlyEvent *> *)events
+{
+    NSMutableArray* events = [NSMutableArray arrayWithCapacity:self.count];
+
+    for (NSUInteger i = 0; i < self.count; i++)
+    {
+        CountlyEvent* event = CountlyEvent.new;
+        event.key = [self stringAtIndex:_keys[i]];
+        event.ID = [self stringAtIndex:_IDs[i]];
+        event.CVID = [self stringAtIndex:_CVIDs[i]];
+        event.PVID = [self stringAtIndex:_PVIDs[i]];
+        event.PEID = [self stringAtIndex:_PEIDs[i]];
+        event.count = _counts[i];
+        event.sum = _sums[i];
+        event.timestamp = _timestamps[i];
+        event.duration = _durations[i];
+        event.hourOfDay = _hoursOfDay[i];
+        event.dayOfWeek = _daysOfWeek[i];
+
+        if (_segmentationStarts[i] != kCountlyArenaNone)
+        {
+            NSMutableDictionary* segmentation = [NSMutableDictionary dictionaryWithCapacity:_segmentationCounts[i]];
+            for (uint32_t s = _segmentationStarts[i]; s < _segmentationStarts[i] + _segmentationCounts[i]; s++)
+            {
+                segmentation[self.strings[_segments[s].key]] = [self segmentValue:_segments[s]];
+            }
+            event.segmentation = segmentation;
+        }
+
+        [events addObject:event];
+    }
+
+    return events;
+}
+
+- (NSData *)serializedEvents
+{
+    if (!self.count)
+        return nil;
+
+    CountlyJSONWriter* writer = [CountlyJSONWriter.alloc initWithMode:CLYJSONWriterModeRaw];
+    [self writeEventsWithWriter:writer];
+    return writer.data;
+}
+
+//NOTE: Writes the same JSON array as serializing CountlyEvent dictionaryRepresentation, without intermediate objects.
+- (void)writeEventsWithWriter:(CountlyJSONWriter *)writer
+{
+    [writer beginArray];
+
+    for (NSUInteger i = 0; i < self.count; i++)
+    {
+        [writer beginObject];
+
+        [writer writeASCIIKey:"key"];
+        [writer writeString:self.strings[_keys[i]]];
+
+        if (_segmentationStarts[i] != kCountlyArenaNone)
+        {
+            [writer writeASCIIKey:"segmentation"];
+            [writer beginObject];
+            for (uint32_t s = _segmentationStarts[i]; s < _segmentationStarts[i] + _segmentationCounts[i]; s++)
+            {
+                [writer writeKey:self.strings[_segments[s].key]];
+                if (_segments[s].type == CountlyArenaValueTypeString)
+                    [writer writeString:self.strings[_segments[s].value]];
+                else
+                    [writer writeObject:self.objects[_segments[s].value]];
+            }
+            [writer endObject];
+        }
+
+        uint32_t identifiers[] = {_IDs[i], _CVIDs[i], _PVIDs[i], _PEIDs[i]};
+        const char* identifierKeys[] = {"id", "cvid", "pvid", "peid"};
+        for (int k = 0; k < 4; k++)
+        {
+            if (identifiers[k] == kCountlyArenaNone)
+                continue;
+
+            [writer writeASCIIKey:identifierKeys[k]];
+            [writer writeString:self.strings[identifiers[k]]];
+        }
+
+        [writer writeASCIIKey:"count"];
+        [writer writeUnsignedLongLong:_counts[i]];
+        [writer writeASCIIKey:"sum"];
+        [writer writeDouble:_sums[i]];
+        [writer writeASCIIKey:"timestamp"];
+        [writer writeLongLong:(long long)(_timestamps[i] * 1000)];
+        [writer writeASCIIKey:"hour"];
+        [writer writeUnsignedLongLong:_hoursOfDay[i]];
+        [writer writeASCIIKey:"dow"];
+        [writer writeUnsignedLongLong:_daysOfWeek[i]];
+        [writer writeASCIIKey:"dur"];
+        [writer writeDouble:_durations[i]];
+
+        [writer endObject];
+    }
+
+    [writer endArray];
+}
+
+- (void)removeAllEvents
+{
+    self.count = 0;
+    _segmentCount = 0;
+
+    [self.strings removeAllObjects];
+    [self.stringIndices removeAllObjects];
+    [self.objects removeAllObjects];
+
+    //NOTE: Release columns grown by a large offline batch, instead of holding onto their memory
+    if (_capacity > kCountlyArenaRetainedCapacityLimit)
+    {
+        [self freeColumns];
+    }
+}
+
+@end
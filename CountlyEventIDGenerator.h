@@ -0,0 +1,22 @@
+// CountlyEventIDGenerator.h
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+//NOTE: Generates event and view IDs: 8 base64 characters followed by millisecond timestamp.
+//NOTE: Base64 part is derived from a per-process random seed and an atomic counter, so IDs do not repeat within a process.
+@interface CountlyEventIDGenerator : NSObject
+
++ (instancetype)sharedInstance;
+
+- (NSString *)nextID;
+- (NSArray<NSString *> *)nextIDs:(NSUInteger)count;
+
+@end
+
+NS_ASSUME_NONNULL_END
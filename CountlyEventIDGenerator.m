@@ -0,0 +1,113 @@
+// CountlyEventIDGenerator.m
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import "CountlyCommon.h"
+#import <stdatomic.h>
+#import <time.h>
+
+static const uint64_t kCountlyEventIDRandomMask = 0xFFFFFFFFFFFFull; //NOTE: 48 bits, encoded as 8 base64 characters
+static const size_t kCountlyEventIDMaxLength = 32;
+
+static const char kCountlyBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+@interface CountlyEventIDGenerator ()
+{
+    uint64_t _seed;
+    _Atomic(uint64_t) _counter;
+}
+@end
+
+@implementation CountlyEventIDGenerator
+
++ (instancetype)sharedInstance
+{
+    static CountlyEventIDGenerator* s_sharedInstance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{s_sharedInstance = self.new;});
+    return s_sharedInstance;
+}
+
+- (instancetype)init
+{
+    if (self = [super init])
+    {
+        arc4random_buf(&_seed, sizeof(_seed));
+        atomic_init(&_counter, 0);
+    }
+
+    return self;
+}
+
+//NOTE: Every step is a bijection on 48 bits, so distinct counter values always give distinct outputs
+static inline uint64_t CountlyEventIDPermute(uint64_t value)
+{
+    value &= kCountlyEventIDRandomMask;
+    value ^= value >> 24;
+    value = (value * 0x9E3779B97F4Bull) & kCountlyEventIDRandomMask;
+    value ^= value >> 23;
+    value = (value * 0xBF58476D1CE5ull) & kCountlyEventIDRandomMask;
+    value ^= value >> 21;
+    return value;
+}
+
+static inline NSString* CountlyEventIDMake(uint64_t random, long long timestamp)
+{
+    char buffer[kCountlyEventIDMaxLength];
+    size_t length = 0;
+
+    for (int shift = 42; shift >= 0; shift -= 6)
+    {
+        buffer[length++] = kCountlyBase64Alphabet[(random >> shift) & 0x3F];
+    }
+
+    char digits[20];
+    size_t digitCount = 0;
+    unsigned long long remaining = timestamp > 0 ? (unsigned long long)timestamp : 0;
+    do
+    {
+        digits[digitCount++] = '0' + (remaining % 10);
+        remaining /= 10;
+    }
+    while (remaining && digitCount < sizeof(digits));
+
+    while (digitCount)
+    {
+        buffer[length++] = digits[--digitCount];
+    }
+
+    return [NSString.alloc initWithBytes:buffer length:length encoding:NSASCIIStringEncoding];
+}
+
+static inline long long CountlyEventIDTimestamp(void)
+{
+    return (long long)(clock_gettime_nsec_np(CLOCK_REALTIME) / NSEC_PER_MSEC);
+}
+
+- (NSString *)nextID
+{
+    uint64_t counter = atomic_fetch_add_explicit(&_counter, 1, memory_order_relaxed);
+    return CountlyEventIDMake(CountlyEventIDPermute(_seed + counter), CountlyEventIDTimestamp());
+}
+
+- (NSArray<NSString *> *)nextIDs:(NSUInteger)count
+{
+    if (!count)
+        return @[];
+
+    //NOTE: Whole range is reserved with a single atomic operation
+    uint64_t first = atomic_fetch_add_explicit(&_counter, count, memory_order_relaxed);
+    long long timestamp = CountlyEventIDTimestamp();
+
+    NSMutableArray* IDs = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        [IDs addObject:CountlyEventIDMake(CountlyEventIDPermute(_seed + first + i), timestamp)];
+    }
+
+    return IDs;
+}
+
+@end
@@ -0,0 +1,35 @@
+// CountlyEventRouter.h
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import <Foundation/Foundation.h>
+#import "Resettable.h"
+
+@class CountlyKeyMatcher;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface CountlyEventRoute : NSObject
+
+@property (nonatomic, readonly) BOOL isReserved;
+@property (nonatomic, readonly) BOOL hasConsent;
+@property (nonatomic, readonly) BOOL isAllowedByServerConfig;
+@property (nonatomic, readonly) BOOL isJourneyTrigger;
+@property (nonatomic, readonly) BOOL hasSegmentationFilter;
+@property (nonatomic, readonly, nullable) CountlyKeyMatcher* eventSegmentationFilter;
+
+@end
+
+
+@interface CountlyEventRouter : NSObject <Resettable>
+
++ (instancetype)sharedInstance;
+
+- (CountlyEventRoute *)routeForEventKey:(NSString *)key;
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,122 @@
+// CountlyEventRouter.m
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import "CountlyCommon.h"
+
+@interface CountlyEventRoute ()
+@property (nonatomic) BOOL isReserved;
+@property (nonatomic) BOOL hasConsent;
+@property (nonatomic) BOOL isAllowedByServerConfig;
+@property (nonatomic) BOOL isJourneyTrigger;
+@property (nonatomic) BOOL hasSegmentationFilter;
+@property (nonatomic, nullable) CountlyKeyMatcher* eventSegmentationFilter;
+@end
+
+@implementation CountlyEventRoute
+@end
+
+
+@interface CountlyEventRouter ()
+@property (nonatomic) NSMutableDictionary<NSString *, CountlyEventRoute *>* routes;
+@property (nonatomic) NSDictionary<NSString *, NSNumber *>* reservedEventConsents;
+@end
+
+//NOTE: Routes for custom event keys are memoized on first use. Table is cleared instead of growing unbounded if an app uses too many distinct keys.
+NSUInteger const kCountlyEventRouteTableLimit = 512;
+
+@implementation CountlyEventRouter
+
+static CountlyEventRouter* s_sharedInstance = nil;
+static dispatch_once_t onceToken;
+
++ (instancetype)sharedInstance
+{
+    if (!CountlyCommon.sharedInstance.hasStarted)
+        return nil;
+
+    dispatch_once(&onceToken, ^{s_sharedInstance = self.new;});
+    return s_sharedInstance;
+}
+
+- (instancetype)init
+{
+    if (self = [super init])
+    {
+        self.routes = NSMutableDictionary.new;
+    }
+
+    return self;
+}
+
+- (void)resetInstance
+{
+    CLY_LOG_I(@"%s", __FUNCTION__);
+    [self invalidate];
+    onceToken = 0;
+    s_sharedInstance = nil;
+}
+
+- (void)invalidate
+{
+    @synchronized (self)
+    {
+        [self.routes removeAllObjects];
+        self.reservedEventConsents = nil;
+    }
+}
+
+- (CountlyEventRoute *)routeForEventKey:(NSString *)key
+{
+    @synchronized (self)
+    {
+        CountlyEventRoute* route = self.routes[key];
+        if (route)
+            return route;
+
+        if (!self.reservedEventConsents)
+            self.reservedEventConsents = [self compileReservedEventConsents];
+
+        route = [self compileRouteForEventKey:key];
+
+        if (self.routes.count >= kCountlyEventRouteTableLimit)
+            [self.routes removeAllObjects];
+
+        self.routes[key] = route;
+        return route;
+    }
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)compileReservedEventConsents
+{
+    CountlyConsentManager* consentManager = CountlyConsentManager.sharedInstance;
+
+    return @{
+        kCountlyReservedEventOrientation: @(consentManager.consentForUserDetails),
+        kCountlyReservedEventStarRating: @(consentManager.consentForFeedback),
+        kCountlyReservedEventSurvey: @(consentManager.consentForFeedback),
+        kCountlyReservedEventNPS: @(consentManager.consentForFeedback),
+        kCountlyReservedEventPushAction: @(consentManager.consentForPushNotifications),
+        kCountlyReservedEventView: @(consentManager.consentForViewTracking),
+    };
+}
+
+- (CountlyEventRoute *)compileRouteForEventKey:(NSString *)key
+{
+    CountlyServerConfig* serverConfig = CountlyServerConfig.sharedInstance;
+    NSNumber* reservedEventConsent = self.reservedEventConsents[key];
+
+    CountlyEventRoute* route = CountlyEventRoute.new;
+    route.isReserved = reservedEventConsent != nil;
+    route.hasConsent = route.isReserved ? reservedEventConsent.boolValue : CountlyConsentManager.sharedInstance.consentForEvents;
+    route.isAllowedByServerConfig = serverConfig.customEventTrackingEnabled && [serverConfig shouldRecordEvent:key];
+    route.isJourneyTrigger = !route.isReserved && [serverConfig isJourneyTriggerEvent:key];
+    route.eventSegmentationFilter = [serverConfig eventSegmentationFilterForEventKey:key];
+    route.hasSegmentationFilter = serverConfig.hasGlobalSegmentationFilter || route.eventSegmentationFilter.count > 0;
+
+    return route;
+}
+
+@end
@@ -0,0 +1,31 @@
+// CountlyHostSelector.h
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+//NOTE: Picks the host to send requests to, out of an ordered list of hosts serving the same app.
+//NOTE: Tracks round trip time and error rate per host, prefers the fastest healthy one,
+//NOTE: and puts hosts with connection errors on an increasing cooldown so requests fail over to the others.
+@interface CountlyHostSelector : NSObject
+
+@property (nonatomic, readonly) NSArray<NSString *>* hosts;
+
+- (instancetype)initWithHosts:(NSArray<NSString *> *)hosts;
+
+- (NSString * _Nullable)currentHost;
+- (BOOL)hasHealthyHostOtherThan:(NSString *)host;
+
+- (void)recordSuccessForHost:(NSString *)host roundTripTime:(NSTimeInterval)roundTripTime;
+- (void)recordFailureForHost:(NSString *)host;
+
+- (NSTimeInterval)roundTripTimeForHost:(NSString *)host;
+- (double)errorRateForHost:(NSString *)host;
+
+@end
+
+NS_ASSUME_NONNULL_END
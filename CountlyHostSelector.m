@@ -0,0 +1,177 @@
+// CountlyHostSelector.m
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import "CountlyCommon.h"
+
+static const double kCountlyHostRoundTripTimeSmoothing = 0.3;
+static const double kCountlyHostErrorRateSmoothing = 0.2;
+static const double kCountlyHostErrorRatePenalty = 4.0;
+static const NSTimeInterval kCountlyHostCooldownBase = 5.0;
+static const NSTimeInterval kCountlyHostCooldownMax = 300.0;
+static const NSUInteger kCountlyHostExplorationInterval = 20;
+
+@interface CountlyHostStats : NSObject
+@property (nonatomic) NSTimeInterval roundTripTime;
+@property (nonatomic) double errorRate;
+@property (nonatomic) NSUInteger consecutiveFailures;
+@property (nonatomic) NSTimeInterval unhealthyUntil;
+@end
+
+@implementation CountlyHostStats
+@end
+
+@interface CountlyHostSelector ()
+@property (nonatomic) NSArray<CountlyHostStats *>* stats;
+@property (nonatomic) NSUInteger selectionCount;
+@end
+
+@implementation CountlyHostSelector
+
+- (instancetype)initWithHosts:(NSArray<NSString *> *)hosts
+{
+    if (self = [super init])
+    {
+        _hosts = hosts.copy;
+
+        NSMutableArray* stats = [NSMutableArray arrayWithCapacity:hosts.count];
+        for (NSUInteger i = 0; i < hosts.count; i++)
+        {
+            [stats addObject:CountlyHostStats.new];
+        }
+        self.stats = stats;
+    }
+
+    return self;
+}
+
+- (CountlyHostStats *)statsForHost:(NSString *)host
+{
+    NSUInteger index = [self.hosts indexOfObject:host];
+    return index == NSNotFound ? nil : self.stats[index];
+}
+
+- (double)scoreForStats:(CountlyHostStats *)stats
+{
+    return stats.roundTripTime * (1.0 + kCountlyHostErrorRatePenalty * stats.errorRate);
+}
+
+- (NSString *)currentHost
+{
+    @synchronized (self)
+    {
+        if (self.hosts.count <= 1)
+            return self.hosts.firstObject;
+
+        NSTimeInterval now = NSDate.date.timeIntervalSince1970;
+        BOOL shouldExplore = (++self.selectionCount % kCountlyHostExplorationInterval) == 0;
+
+        NSInteger selected = NSNotFound;
+        NSInteger earliestRecovering = NSNotFound;
+
+        for (NSUInteger i = 0; i < self.hosts.count; i++)
+        {
+            CountlyHostStats* stats = self.stats[i];
+
+            if (stats.unhealthyUntil > now)
+            {
+                if (earliestRecovering == NSNotFound || stats.unhealthyUntil < self.stats[earliestRecovering].unhealthyUntil)
+                    earliestRecovering = i;
+
+                continue;
+            }
+
+            //NOTE: Once in a while, a healthy host without any measurement is tried, so a faster one can be discovered
+            if (shouldExplore && stats.roundTripTime == 0)
+            {
+                selected = i;
+                break;
+            }
+
+            if (selected == NSNotFound)
+            {
+                selected = i;
+                continue;
+            }
+
+            CountlyHostStats* selectedStats = self.stats[selected];
+            if (stats.roundTripTime > 0 && selectedStats.roundTripTime > 0 && [self scoreForStats:stats] < [self scoreForStats:selectedStats])
+                selected = i;
+        }
+
+        //NOTE: If all hosts are cooling down, the one recovering first is used
+        if (selected == NSNotFound)
+            selected = earliestRecovering;
+
+        return self.hosts[selected];
+    }
+}
+
+- (BOOL)hasHealthyHostOtherThan:(NSString *)host
+{
+    @synchronized (self)
+    {
+        NSTimeInterval now = NSDate.date.timeIntervalSince1970;
+        for (NSUInteger i = 0; i < self.hosts.count; i++)
+        {
+            if (![self.hosts[i] isEqualToString:host] && self.stats[i].unhealthyUntil <= now)
+                return YES;
+        }
+
+        return NO;
+    }
+}
+
+- (void)recordSuccessForHost:(NSString *)host roundTripTime:(NSTimeInterval)roundTripTime
+{
+    @synchronized (self)
+    {
+        CountlyHostStats* stats = [self statsForHost:host];
+        if (!stats)
+            return;
+
+        roundTripTime = MAX(roundTripTime, 0.001);
+        stats.roundTripTime = stats.roundTripTime ? stats.roundTripTime + kCountlyHostRoundTripTimeSmoothing * (roundTripTime - stats.roundTripTime) : roundTripTime;
+        stats.errorRate *= (1.0 - kCountlyHostErrorRateSmoothing);
+        stats.consecutiveFailures = 0;
+        stats.unhealthyUntil = 0;
+    }
+}
+
+- (void)recordFailureForHost:(NSString *)host
+{
+    @synchronized (self)
+    {
+        CountlyHostStats* stats = [self statsForHost:host];
+        if (!stats)
+            return;
+
+        stats.errorRate += kCountlyHostErrorRateSmoothing * (1.0 - stats.errorRate);
+        stats.consecutiveFailures++;
+
+        NSTimeInterval cooldown = MIN(kCountlyHostCooldownBase * pow(2, stats.consecutiveFailures - 1), kCountlyHostCooldownMax);
+        stats.unhealthyUntil = NSDate.date.timeIntervalSince1970 + cooldown;
+
+        CLY_LOG_D(@"%s, Host [ %@ ] failed %lu time(s) in a row, cooling down for %.0f seconds", __FUNCTION__, host, (unsigned long)stats.consecutiveFailures, cooldown);
+    }
+}
+
+- (NSTimeInterval)roundTripTimeForHost:(NSString *)host
+{
+    @synchronized (self)
+    {
+        return [self statsForHost:host].roundTripTime;
+    }
+}
+
+- (double)errorRateForHost:(NSString *)host
+{
+    @synchronized (self)
+    {
+        return [self statsForHost:host].errorRate;
+    }
+}
+
+@end
@@ -0,0 +1,46 @@
+// CountlyJSONWriter.h
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSUInteger, CLYJSONWriterMode)
+{
+    CLYJSONWriterModeRaw,
+    CLYJSONWriterModeURLEscaped,
+};
+
+//NOTE: Streaming JSON encoder writing directly into a reusable byte buffer.
+//NOTE: In URL escaped mode, output is percent-encoded as it is written, so it can be used as a query string value as is.
+//NOTE: Not thread-safe, each writer should be used by one thread at a time.
+@interface CountlyJSONWriter : NSObject
+
+@property (nonatomic, readonly) CLYJSONWriterMode mode;
+@property (nonatomic, readonly) NSData* data;
+
+- (instancetype)initWithMode:(CLYJSONWriterMode)mode;
+
+- (void)reset;
+- (NSString *)string;
+
+- (void)beginObject;
+- (void)endObject;
+- (void)beginArray;
+- (void)endArray;
+
+- (void)writeKey:(NSString *)key;
+- (void)writeASCIIKey:(const char *)key;
+
+- (void)writeString:(NSString *)string;
+- (void)writeDouble:(double)value;
+- (void)writeLongLong:(long long)value;
+- (void)writeUnsignedLongLong:(unsigned long long)value;
+- (BOOL)writeObject:(id)object;
+
+@end
+
+NS_ASSUME_NONNULL_END
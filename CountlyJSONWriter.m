@@ -0,0 +1,350 @@
+// CountlyJSONWriter.m
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import "CountlyCommon.h"
+
+//NOTE: Objects nested deeper than this are written as null by `writeObject:`, so deeply nested structures can not exhaust the stack
+static const NSUInteger kCountlyJSONWriterMaxDepth = 64;
+static const NSUInteger kCountlyJSONWriterInitialCapacity = 1024;
+
+static inline BOOL CountlyIsURLUnreserved(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+@interface CountlyJSONWriter ()
+{
+    NSMutableData* _buffer;
+    NSUInteger _depth;
+    NSMutableData* _separatorStack;
+    BOOL _isAfterKey;
+}
+@end
+
+@implementation CountlyJSONWriter
+
+- (instancetype)initWithMode:(CLYJSONWriterMode)mode
+{
+    if (self = [super init])
+    {
+        _mode = mode;
+        _buffer = [NSMutableData dataWithCapacity:kCountlyJSONWriterInitialCapacity];
+        _separatorStack = [NSMutableData dataWithLength:kCountlyJSONWriterMaxDepth + 1];
+    }
+
+    return self;
+}
+
+- (NSData *)data
+{
+    return _buffer;
+}
+
+- (void)reset
+{
+    _buffer.length = 0;
+    _depth = 0;
+    ((BOOL *)_separatorStack.mutableBytes)[0] = NO;
+    _isAfterKey = NO;
+}
+
+- (NSString *)string
+{
+    return [NSString.alloc initWithData:_buffer encoding:NSUTF8StringEncoding];
+}
+
+#pragma mark - Output
+
+- (void)appendBytes:(const char *)bytes length:(size_t)length
+{
+    if (self.mode == CLYJSONWriterModeRaw)
+    {
+        [_buffer appendBytes:bytes length:length];
+        return;
+    }
+
+    static const char hex[] = "0123456789ABCDEF";
+    size_t runStart = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned char c = (unsigned char)bytes[i];
+        if (CountlyIsURLUnreserved(c))
+            continue;
+
+        if (i > runStart)
+            [_buffer appendBytes:bytes + runStart length:i - runStart];
+
+        char escaped[] = {'%', hex[c >> 4], hex[c & 0xF]};
+        [_buffer appendBytes:escaped length:sizeof(escaped)];
+        runStart = i + 1;
+    }
+
+    if (length > runStart)
+        [_buffer appendBytes:bytes + runStart length:length - runStart];
+}
+
+- (void)appendCString:(const char *)string
+{
+    [self appendBytes:string length:strlen(string)];
+}
+
+- (void)appendQuotedString:(NSString *)string
+{
+    static const char hex[] = "0123456789abcdef";
+
+    //NOTE: Length is not taken with strlen, as strings may contain NUL characters
+    const char* UTF8 = CFStringGetCStringPtr((__bridge CFStringRef)string, kCFStringEncodingUTF8) ?: string.UTF8String;
+    size_t length = UTF8 ? [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding] : 0;
+    size_t runStart = 0;
+
+    [self appendBytes:"\"" length:1];
+
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned char c = (unsigned char)UTF8[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        if (i > runStart)
+            [self appendBytes:UTF8 + runStart length:i - runStart];
+        runStart = i + 1;
+
+        switch (c)
+        {
+            case '"':  [self appendBytes:"\\\"" length:2]; break;
+            case '\\': [self appendBytes:"\\\\" length:2]; break;
+            case '\n': [self appendBytes:"\\n" length:2]; break;
+            case '\r': [self appendBytes:"\\r" length:2]; break;
+            case '\t': [self appendBytes:"\\t" length:2]; break;
+            default:
+            {
+                char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                [self appendBytes:escaped length:sizeof(escaped)];
+            }
+        }
+    }
+
+    if (length > runStart)
+        [self appendBytes:UTF8 + runStart length:length - runStart];
+
+    [self appendBytes:"\"" length:1];
+}
+
+- (void)prepareForValue
+{
+    if (_isAfterKey)
+    {
+        _isAfterKey = NO;
+        return;
+    }
+
+    BOOL* needsSeparator = (BOOL *)_separatorStack.mutableBytes;
+    if (needsSeparator[_depth])
+        [self appendBytes:"," length:1];
+
+    needsSeparator[_depth] = YES;
+}
+
+- (void)pushContainer:(const char *)opening
+{
+    [self prepareForValue];
+    [self appendBytes:opening length:1];
+
+    _depth++;
+    if (_depth >= _separatorStack.length)
+        _separatorStack.length = _depth * 2;
+
+    ((BOOL *)_separatorStack.mutableBytes)[_depth] = NO;
+}
+
+- (void)popContainer:(const char *)closing
+{
+    [self appendBytes:closing length:1];
+
+    if (_depth > 0)
+        _depth--;
+}
+
+#pragma mark - Structure
+
+- (void)beginObject
+{
+    [self pushContainer:"{"];
+}
+
+- (void)endObject
+{
+    [self popContainer:"}"];
+}
+
+- (void)beginArray
+{
+    [self pushContainer:"["];
+}
+
+- (void)endArray
+{
+    [self popContainer:"]"];
+}
+
+- (void)writeKey:(NSString *)key
+{
+    [self prepareForValue];
+    [self appendQuotedString:key];
+    [self appendBytes:":" length:1];
+    _isAfterKey = YES;
+}
+
+//NOTE: Given key must be a JSON-safe ASCII string, so it is written without escaping checks.
+- (void)writeASCIIKey:(const char *)key
+{
+    [self prepareForValue];
+    [self appendBytes:"\"" length:1];
+    [self appendCString:key];
+    [self appendBytes:"\":" length:2];
+    _isAfterKey = YES;
+}
+
+#pragma mark - Values
+
+- (void)writeString:(NSString *)string
+{
+    [self prepareForValue];
+    [self appendQuotedString:string];
+}
+
+- (void)writeDouble:(double)value
+{
+    [self prepareForValue];
+
+    if (!isfinite(value))
+    {
+        [self appendCString:"null"];
+        return;
+    }
+
+    char buffer[32];
+    if (value == floor(value) && fabs(value) < 9007199254740992.0)
+    {
+        snprintf(buffer, sizeof(buffer), "%lld", (long long)value);
+    }
+    else
+    {
+        snprintf(buffer, sizeof(buffer), "%.15g", value);
+        if (strtod(buffer, NULL) != value)
+            snprintf(buffer, sizeof(buffer), "%.17g", value);
+    }
+
+    [self appendCString:buffer];
+}
+
+- (void)writeLongLong:(long long)value
+{
+    [self prepareForValue];
+
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%lld", value);
+    [self appendCString:buffer];
+}
+
+- (void)writeUnsignedLongLong:(unsigned long long)value
+{
+    [self prepareForValue];
+
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%llu", value);
+    [self appendCString:buffer];
+}
+
+- (void)writeNull
+{
+    [self prepareForValue];
+    [self appendCString:"null"];
+}
+
+//NOTE: Returns NO if given object (or any of its contents) can not be represented in JSON. Those are written as null.
+- (BOOL)writeObject:(id)object
+{
+    if ([object isKindOfClass:NSString.class])
+    {
+        [self writeString:object];
+        return YES;
+    }
+
+    if ([object isKindOfClass:NSNumber.class])
+    {
+        NSNumber* number = object;
+        if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID())
+        {
+            [self prepareForValue];
+            [self appendCString:number.boolValue ? "true" : "false"];
+            return YES;
+        }
+
+        switch (number.objCType[0])
+        {
+            case 'f':
+            case 'd':
+                [self writeDouble:number.doubleValue];
+                return isfinite(number.doubleValue);
+            case 'Q':
+            case 'L':
+            case 'I':
+            case 'S':
+            case 'C':
+                [self writeUnsignedLongLong:number.unsignedLongLongValue];
+                return YES;
+            default:
+                [self writeLongLong:number.longLongValue];
+                return YES;
+        }
+    }
+
+    BOOL isContainer = [object isKindOfClass:NSArray.class] || [object isKindOfClass:NSDictionary.class];
+    if (isContainer && _depth >= kCountlyJSONWriterMaxDepth)
+    {
+        CLY_LOG_W(@"%s, Object is nested deeper than %lu levels, it is written as null", __FUNCTION__, (unsigned long)kCountlyJSONWriterMaxDepth);
+        [self writeNull];
+        return NO;
+    }
+
+    if ([object isKindOfClass:NSArray.class])
+    {
+        BOOL isValid = YES;
+        [self beginArray];
+        for (id element in (NSArray *)object)
+        {
+            isValid = [self writeObject:element] && isValid;
+        }
+        [self endArray];
+        return isValid;
+    }
+
+    if ([object isKindOfClass:NSDictionary.class])
+    {
+        BOOL isValid = YES;
+        [self beginObject];
+        for (id key in (NSDictionary *)object)
+        {
+            if (![key isKindOfClass:NSString.class])
+            {
+                isValid = NO;
+                continue;
+            }
+
+            [self writeKey:key];
+            isValid = [self writeObject:((NSDictionary *)object)[key]] && isValid;
+        }
+        [self endObject];
+        return isValid;
+    }
+
+    [self writeNull];
+    return [object isKindOfClass:NSNull.class];
+}
+
+@end
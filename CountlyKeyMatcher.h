@@ -0,0 +1,26 @@
+// CountlyKeyMatcher.h
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+//NOTE: Matches keys against a compiled list of patterns. A pattern is either an exact key, a prefix (`checkout_*`) or a glob using `*` and `?` (`*_debug`, `screen_?`).
+//NOTE: A literal `*`, `?` or backslash is escaped with a backslash (`Rate us\?`).
+//NOTE: Exact and prefix patterns are compiled into a trie, so a lookup walks the key once. Results are memoized per key.
+@interface CountlyKeyMatcher : NSObject
+
++ (instancetype)matcherWithPatterns:(NSArray *)patterns;
++ (instancetype)matcherWithPatternsAndObjects:(NSDictionary<NSString *, id> *)patternsAndObjects;
+
+@property (nonatomic, readonly) NSUInteger count;
+
+- (BOOL)matchesKey:(NSString *)key;
+- (nullable id)objectForKey:(NSString *)key;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,324 @@
+// CountlyKeyMatcher.m
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import "CountlyCommon.h"
+
+typedef struct
+{
+    uint32_t firstEdge;
+    uint32_t edgeCount;
+    int32_t exactObject;
+    int32_t prefixObject;
+} CountlyKeyMatcherNode;
+
+typedef struct
+{
+    UniChar character;
+    uint32_t node;
+} CountlyKeyMatcherEdge;
+
+static const uint32_t kCountlyKeyMatcherNoNode = UINT32_MAX;
+
+//NOTE: Results are memoized per key. Table is cleared instead of growing unbounded if an app uses too many distinct keys.
+NSUInteger const kCountlyKeyMatcherResultTableLimit = 512;
+
+static inline BOOL CountlyKeyMatcherIsEscapable(UniChar c)
+{
+    return c == '*' || c == '?' || c == '\\';
+}
+
+//NOTE: A backslash escapes a following `*`, `?` or backslash, so it is matched literally. A backslash before anything else is literal itself.
+static BOOL CountlyKeyMatcherGlobMatches(NSString* glob, CFStringInlineBuffer* key, CFIndex keyLength)
+{
+    CFStringInlineBuffer pattern;
+    CFIndex patternLength = CFStringGetLength((CFStringRef)glob);
+    CFStringInitInlineBuffer((CFStringRef)glob, &pattern, CFRangeMake(0, patternLength));
+
+    CFIndex p = 0;
+    CFIndex k = 0;
+    CFIndex star = kCFNotFound;
+    CFIndex resume = 0;
+
+    while (k < keyLength)
+    {
+        UniChar c = p < patternLength ? CFStringGetCharacterFromInlineBuffer(&pattern, p) : 0;
+        BOOL isEscaped = c == '\\' && p + 1 < patternLength && CountlyKeyMatcherIsEscapable(CFStringGetCharacterFromInlineBuffer(&pattern, p + 1));
+        if (isEscaped)
+            c = CFStringGetCharacterFromInlineBuffer(&pattern, p + 1);
+
+        if (p < patternLength && c == '*' && !isEscaped)
+        {
+            star = p++;
+            resume = k;
+        }
+        else if (p < patternLength && ((c == '?' && !isEscaped) || c == CFStringGetCharacterFromInlineBuffer(key, k)))
+        {
+            p += isEscaped ? 2 : 1;
+            k++;
+        }
+        else if (star != kCFNotFound)
+        {
+            p = star + 1;
+            k = ++resume;
+        }
+        else
+        {
+            return NO;
+        }
+    }
+
+    while (p < patternLength && CFStringGetCharacterFromInlineBuffer(&pattern, p) == '*')
+        p++;
+
+    return p == patternLength;
+}
+
+@interface CountlyKeyMatcher ()
+{
+    CountlyKeyMatcherNode* _nodes;
+    CountlyKeyMatcherEdge* _edges;
+    NSUInteger _nodeCount;
+}
+@property (nonatomic) NSUInteger count;
+@property (nonatomic) NSArray* objects;
+@property (nonatomic) NSArray<NSString *>* globs;
+@property (nonatomic) NSArray<NSNumber *>* globObjects;
+@property (nonatomic) NSMutableDictionary<NSString *, id>* results;
+@end
+
+@implementation CountlyKeyMatcher
+
++ (instancetype)matcherWithPatterns:(NSArray *)patterns
+{
+    NSMutableDictionary* patternsAndObjects = NSMutableDictionary.new;
+    for (NSString* pattern in patterns)
+    {
+        if ([pattern isKindOfClass:NSString.class])
+            patternsAndObjects[pattern] = @YES;
+    }
+
+    return [self matcherWithPatternsAndObjects:patternsAndObjects];
+}
+
++ (instancetype)matcherWithPatternsAndObjects:(NSDictionary<NSString *, id> *)patternsAndObjects
+{
+    return [self.alloc initWithPatternsAndObjects:patternsAndObjects];
+}
+
+- (instancetype)initWithPatternsAndObjects:(NSDictionary<NSString *, id> *)patternsAndObjects
+{
+    if (self = [super init])
+    {
+        self.results = NSMutableDictionary.new;
+        [self compilePatternsAndObjects:patternsAndObjects];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_nodes);
+    free(_edges);
+}
+
+- (void)compilePatternsAndObjects:(NSDictionary<NSString *, id> *)patternsAndObjects
+{
+    NSMutableArray* patterns = NSMutableArray.new;
+    [patternsAndObjects enumerateKeysAndObjectsUsingBlock:^(NSString* pattern, id object, BOOL* stop)
+    {
+        if ([pattern isKindOfClass:NSString.class])
+            [patterns addObject:pattern];
+    }];
+
+    //NOTE: Sorted so globs are always tried in the same order, regardless of dictionary ordering
+    [patterns sortUsingSelector:@selector(compare:)];
+
+    NSMutableArray* objects = NSMutableArray.new;
+    NSMutableArray* globs = NSMutableArray.new;
+    NSMutableArray* globObjects = NSMutableArray.new;
+    NSMutableArray<NSMutableDictionary<NSNumber *, NSNumber *> *>* children = [NSMutableArray arrayWithObject:NSMutableDictionary.new];
+
+    NSUInteger nodeCapacity = 16;
+    _nodes = malloc(nodeCapacity * sizeof(CountlyKeyMatcherNode));
+    _nodes[0] = (CountlyKeyMatcherNode){0, 0, -1, -1};
+    _nodeCount = 1;
+
+    for (NSString* pattern in patterns)
+    {
+        //NOTE: Pattern is unescaped into its literal characters, while keeping track of unescaped wildcards
+        NSUInteger length = pattern.length;
+        NSMutableString* literal = [NSMutableString stringWithCapacity:length];
+        NSUInteger wildcardCount = 0;
+        BOOL isPrefix = NO;
+        for (NSUInteger i = 0; i < length; i++)
+        {
+            unichar c = [pattern characterAtIndex:i];
+            if (c == '\\' && i + 1 < length && CountlyKeyMatcherIsEscapable([pattern characterAtIndex:i + 1]))
+            {
+                c = [pattern characterAtIndex:++i];
+            }
+            else if (c == '*' || c == '?')
+            {
+                wildcardCount++;
+                isPrefix = c == '*' && i == length - 1 && wildcardCount == 1;
+                continue;
+            }
+
+            [literal appendFormat:@"%C", c];
+        }
+
+        if (wildcardCount > 0 && !isPrefix)
+        {
+            [globs addObject:pattern];
+            [globObjects addObject:@(objects.count)];
+            [objects addObject:patternsAndObjects[pattern]];
+            continue;
+        }
+
+        NSUInteger node = 0;
+        for (NSUInteger i = 0; i < literal.length; i++)
+        {
+            NSNumber* character = @([literal characterAtIndex:i]);
+            NSNumber* next = children[node][character];
+            if (!next)
+            {
+                if (_nodeCount == nodeCapacity)
+                {
+                    nodeCapacity *= 2;
+                    _nodes = realloc(_nodes, nodeCapacity * sizeof(CountlyKeyMatcherNode));
+                }
+
+                _nodes[_nodeCount] = (CountlyKeyMatcherNode){0, 0, -1, -1};
+                next = @(_nodeCount++);
+                children[node][character] = next;
+                [children addObject:NSMutableDictionary.new];
+            }
+
+            node = next.unsignedIntegerValue;
+        }
+
+        int32_t object = (int32_t)objects.count;
+        [objects addObject:patternsAndObjects[pattern]];
+
+        if (isPrefix)
+            _nodes[node].prefixObject = object;
+        else
+            _nodes[node].exactObject = object;
+    }
+
+    //NOTE: Every node except the root has exactly one incoming edge. Edges of a node are stored contiguously and sorted for binary search.
+    _edges = malloc(MAX(_nodeCount - 1, 1) * sizeof(CountlyKeyMatcherEdge));
+    uint32_t edge = 0;
+    for (NSUInteger node = 0; node < _nodeCount; node++)
+    {
+        _nodes[node].firstEdge = edge;
+        _nodes[node].edgeCount = (uint32_t)children[node].count;
+
+        for (NSNumber* character in [children[node].allKeys sortedArrayUsingSelector:@selector(compare:)])
+            _edges[edge++] = (CountlyKeyMatcherEdge){character.unsignedShortValue, children[node][character].unsignedIntValue};
+    }
+
+    self.count = objects.count;
+    self.objects = objects.copy;
+    self.globs = globs.copy;
+    self.globObjects = globObjects.copy;
+}
+
+- (BOOL)matchesKey:(NSString *)key
+{
+    return [self objectForKey:key] != nil;
+}
+
+- (id)objectForKey:(NSString *)key
+{
+    if (self.count == 0 || ![key isKindOfClass:NSString.class])
+        return nil;
+
+    @synchronized (self)
+    {
+        id result = self.results[key];
+        if (result)
+            return result == NSNull.null ? nil : result;
+    }
+
+    id result = [self compiledObjectForKey:key];
+
+    @synchronized (self)
+    {
+        if (self.results.count >= kCountlyKeyMatcherResultTableLimit)
+            [self.results removeAllObjects];
+
+        self.results[key] = result ?: NSNull.null;
+    }
+
+    return result;
+}
+
+//NOTE: Exact match takes precedence over the longest matching prefix, which takes precedence over globs.
+- (id)compiledObjectForKey:(NSString *)key
+{
+    CFIndex length = CFStringGetLength((CFStringRef)key);
+    CFStringInlineBuffer buffer;
+    CFStringInitInlineBuffer((CFStringRef)key, &buffer, CFRangeMake(0, length));
+
+    int32_t object = -1;
+    uint32_t node = 0;
+    CFIndex i = 0;
+    for (; i < length; i++)
+    {
+        if (_nodes[node].prefixObject >= 0)
+            object = _nodes[node].prefixObject;
+
+        uint32_t next = [self childOfNode:node character:CFStringGetCharacterFromInlineBuffer(&buffer, i)];
+        if (next == kCountlyKeyMatcherNoNode)
+            break;
+
+        node = next;
+    }
+
+    if (i == length)
+    {
+        if (_nodes[node].exactObject >= 0)
+            object = _nodes[node].exactObject;
+        else if (_nodes[node].prefixObject >= 0)
+            object = _nodes[node].prefixObject;
+    }
+
+    if (object >= 0)
+        return self.objects[object];
+
+    for (NSUInteger g = 0; g < self.globs.count; g++)
+    {
+        if (CountlyKeyMatcherGlobMatches(self.globs[g], &buffer, length))
+            return self.objects[self.globObjects[g].unsignedIntegerValue];
+    }
+
+    return nil;
+}
+
+- (uint32_t)childOfNode:(uint32_t)node character:(UniChar)character
+{
+    CountlyKeyMatcherEdge* edges = _edges + _nodes[node].firstEdge;
+    uint32_t low = 0;
+    uint32_t high = _nodes[node].edgeCount;
+
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        if (edges[middle].character == character)
+            return edges[middle].node;
+
+        if (edges[middle].character < character)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return kCountlyKeyMatcherNoNode;
+}
+
+@end
@@ -0,0 +1,33 @@
+// CountlyNetworkStateMonitor.h
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSUInteger, CLYNetworkLinkType)
+{
+    CLYNetworkLinkTypeUnknown,
+    CLYNetworkLinkTypeOffline,
+    CLYNetworkLinkTypeUnmetered,
+    CLYNetworkLinkTypeMetered,
+};
+
+//NOTE: Source of network and power state used for scheduling requests in the queue.
+//NOTE: Can be replaced with a custom implementation, for example to test scheduling headlessly.
+@protocol CountlyNetworkStateProvider <NSObject>
+- (CLYNetworkLinkType)linkType;
+- (BOOL)isPowerConstrained;
+@optional
+//NOTE: Executed on an arbitrary queue whenever link type changes, so deferred requests can be sent once the device is back online.
+@property (nonatomic, copy, nullable) void (^linkTypeChangeHandler)(CLYNetworkLinkType previousLinkType, CLYNetworkLinkType linkType);
+@end
+
+//NOTE: Default provider, based on network path monitor, low power mode and battery level.
+@interface CountlyNetworkStateMonitor : NSObject <CountlyNetworkStateProvider>
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,130 @@
+// CountlyNetworkStateMonitor.m
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import "CountlyCommon.h"
+
+#if (TARGET_OS_IOS)
+#import <Network/Network.h>
+#endif
+
+static const NSInteger kCountlyLowBatteryLevel = 20;
+
+@interface CountlyNetworkStateMonitor ()
+@property (atomic) CLYNetworkLinkType currentLinkType;
+@property (atomic) BOOL isBatteryLow;
+#if (TARGET_OS_IOS)
+@property (nonatomic) id pathMonitor; //NOTE: nw_path_monitor_t, typed as id since it is not available before iOS 12
+#endif
+@end
+
+@implementation CountlyNetworkStateMonitor
+@synthesize linkTypeChangeHandler;
+
+- (instancetype)init
+{
+    if (self = [super init])
+    {
+        self.currentLinkType = CLYNetworkLinkTypeUnknown;
+#if (TARGET_OS_IOS || TARGET_OS_VISION)
+        __weak typeof(self) weakSelf = self;
+#endif
+
+#if (TARGET_OS_IOS)
+        //NOTE: Link type is updated from path monitor callbacks, so checking it while scheduling requests is just a read.
+        //NOTE: Until the first callback arrives link type stays unknown, which never defers requests.
+        if (@available(iOS 12.0, *))
+        {
+            nw_path_monitor_t pathMonitor = nw_path_monitor_create();
+            nw_path_monitor_set_queue(pathMonitor, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+            nw_path_monitor_set_update_handler(pathMonitor, ^(nw_path_t path)
+            {
+                [weakSelf updateLinkType:[CountlyNetworkStateMonitor linkTypeForPath:path]];
+            });
+            nw_path_monitor_start(pathMonitor);
+            self.pathMonitor = pathMonitor;
+        }
+#endif
+
+#if (TARGET_OS_IOS || TARGET_OS_VISION)
+        //NOTE: UIDevice is read only on main thread, and cached battery state is refreshed by notifications.
+        //NOTE: Notifications are posted only if battery monitoring is enabled by the app. Otherwise battery level is unknown and not taken into account.
+        [NSNotificationCenter.defaultCenter addObserver:self selector:@selector(refreshBatteryState) name:UIDeviceBatteryLevelDidChangeNotification object:nil];
+        [NSNotificationCenter.defaultCenter addObserver:self selector:@selector(refreshBatteryState) name:UIDeviceBatteryStateDidChangeNotification object:nil];
+        dispatch_async(dispatch_get_main_queue(), ^
+        {
+            [weakSelf refreshBatteryState];
+        });
+#endif
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+#if (TARGET_OS_IOS)
+    if (@available(iOS 12.0, *))
+    {
+        if (_pathMonitor)
+            nw_path_monitor_cancel(_pathMonitor);
+    }
+#endif
+    [NSNotificationCenter.defaultCenter removeObserver:self];
+}
+
+- (void)updateLinkType:(CLYNetworkLinkType)linkType
+{
+    CLYNetworkLinkType previousLinkType = self.currentLinkType;
+    self.currentLinkType = linkType;
+
+    void (^handler)(CLYNetworkLinkType, CLYNetworkLinkType) = self.linkTypeChangeHandler;
+    if (handler && previousLinkType != linkType)
+        handler(previousLinkType, linkType);
+}
+
+#if (TARGET_OS_IOS)
++ (CLYNetworkLinkType)linkTypeForPath:(nw_path_t)path API_AVAILABLE(ios(12.0))
+{
+    switch (nw_path_get_status(path))
+    {
+        case nw_path_status_satisfied:
+            return nw_path_is_expensive(path) ? CLYNetworkLinkTypeMetered : CLYNetworkLinkTypeUnmetered;
+
+        case nw_path_status_unsatisfied:
+            return CLYNetworkLinkTypeOffline;
+
+        default:
+            return CLYNetworkLinkTypeUnknown;
+    }
+}
+#endif
+
+#if (TARGET_OS_IOS || TARGET_OS_VISION)
+- (void)refreshBatteryState
+{
+    NSInteger batteryLevel = CountlyDeviceInfo.batteryLevel;
+    self.isBatteryLow = batteryLevel >= 0 && batteryLevel <= kCountlyLowBatteryLevel;
+}
+#endif
+
+- (CLYNetworkLinkType)linkType
+{
+    //NOTE: On other platforms there is no monitor, so link type is always unknown
+    return self.currentLinkType;
+}
+
+- (BOOL)isPowerConstrained
+{
+    if (@available(iOS 9.0, macOS 12.0, tvOS 9.0, watchOS 2.0, *))
+    {
+        if (NSProcessInfo.processInfo.lowPowerModeEnabled)
+            return YES;
+    }
+
+    return self.isBatteryLow;
+}
+
+@end
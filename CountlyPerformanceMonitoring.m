@@ -259,8 +259,9 @@ BOOL enableForegroundBackgroundTracking;
             return;
         }
 
+        //NOTE: Monotonic start time is kept alongside, so duration is not affected by device clock changes
         NSNumber* startTime = @((long long)(CountlyCommon.sharedInstance.uniqueTimestamp * 1000));
-        self.startedCustomTraces[traceName] = startTime;
+        self.startedCustomTraces[traceName] = @[startTime, @(CountlyClock.sharedInstance.monotonicTime)];
     }
     
     CLY_LOG_D(@"Custom trace with name '%@' just started!", traceName);
@@ -274,15 +275,15 @@ BOOL enableForegroundBackgroundTracking;
     if (!traceName.length)
         return;
 
-    NSNumber* startTime = nil;
+    NSArray* startTimes = nil;
 
     @synchronized (self.startedCustomTraces)
     {
-        startTime = self.startedCustomTraces[traceName];
+        startTimes = self.startedCustomTraces[traceName];
         [self.startedCustomTraces removeObjectForKey:traceName];
     }
 
-    if (!startTime)
+    if (!startTimes)
     {
         CLY_LOG_W(@"Custom trace with name '%@' not started yet or cancelled/ended before!", traceName);
         return;
@@ -292,13 +293,14 @@ BOOL enableForegroundBackgroundTracking;
     NSDictionary* metricsTruncated = [metrics cly_truncated:@"Custom trace metric"];
     metrics = [metricsTruncated cly_limited:@"Custom trace metric"];
 
-    NSNumber* endTime = @((long long)(CountlyCommon.sharedInstance.uniqueTimestamp * 1000));
+    NSNumber* startTime = startTimes[0];
+    long long duration = (long long)((CountlyClock.sharedInstance.monotonicTime - [startTimes[1] doubleValue]) * 1000);
+    NSNumber* endTime = @(startTime.longLongValue + duration);
 
     NSMutableDictionary* mutableMetrics = metrics.mutableCopy;
     if (!mutableMetrics)
         mutableMetrics = NSMutableDictionary.new;
 
-    long long duration = endTime.longLongValue - startTime.longLongValue;
     mutableMetrics[kCountlyPMKeyDuration] = @(duration);
 
     NSDictionary* trace =
@@ -323,15 +325,15 @@ BOOL enableForegroundBackgroundTracking;
     if (!traceName.length)
         return;
 
-    NSNumber* startTime = nil;
+    NSArray* startTimes = nil;
 
     @synchronized (self.startedCustomTraces)
     {
-        startTime = self.startedCustomTraces[traceName];
+        startTimes = self.startedCustomTraces[traceName];
         [self.startedCustomTraces removeObjectForKey:traceName];
     }
 
-    if (!startTime)
+    if (!startTimes)
     {
         CLY_LOG_W(@"Custom trace with name '%@' not started yet or cancelled/ended before!", traceName);
         return;
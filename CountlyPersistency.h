@@ -9,15 +9,29 @@
 
 @class CountlyEvent;
 
+//NOTE: Request classes, in order of priority. Each class has its own lane in the request queue.
+typedef NS_ENUM(NSUInteger, CLYRequestClass)
+{
+    CLYRequestClassControl,
+    CLYRequestClassCrash,
+    CLYRequestClassUserDetails,
+    CLYRequestClassEvents,
+    CLYRequestClassAPM,
+    CLYRequestClassCount,
+};
+
+CLYRequestClass CountlyRequestClassForQueryString(NSString* queryString);
+
 @interface CountlyPersistency : NSObject <Resettable>
 
 + (instancetype)sharedInstance;
 
 - (void)addToQueue:(NSString *)queryString;
 - (void)removeFromQueue:(NSString *)queryString;
-- (NSString *)firstItemInQueue;
+- (NSString *)nextItemInQueue;
 - (void)flushQueue;
 - (NSUInteger)remainingRequestCount;
+- (BOOL)hasQueuedRequestOfClass:(CLYRequestClass)requestClass;
 - (void)replaceAllTemporaryDeviceIDsInQueueWithDeviceID:(NSString *)deviceID;
 - (void)replaceAllAppKeysInQueueWithCurrentAppKey;
 - (void)removeDifferentAppKeysFromQueue;
@@ -25,6 +39,7 @@
 
 - (void)recordEvent:(CountlyEvent *)event;
 - (void)recordEvent:(CountlyEvent *)event callback:(CLYRequestCallback)callback;
+- (void)recordEvents:(NSArray<CountlyEvent *> *)events callback:(CLYRequestCallback)callback;
 - (NSString *)serializedRecordedEvents;
 - (void)flushEvents;
 
@@ -59,10 +74,15 @@
 
 - (NSDictionary *)retrieveRemoteConfig;
 - (void)storeRemoteConfig:(NSDictionary *)remoteConfig;
+- (NSTimeInterval)retrieveRemoteConfigFetchTime;
+- (void)storeRemoteConfigFetchTime:(NSTimeInterval)fetchTime;
 
 - (NSMutableDictionary *)retrieveServerConfig;
 - (void)storeServerConfig:(NSMutableDictionary *)serverConfig;
 
+- (NSArray *)retrieveUserDetailsAcknowledgedHashes;
+- (void)storeUserDetailsAcknowledgedHashes:(NSArray *)acknowledgedHashes;
+
 - (NSDictionary *)retrieveHealthCheckTrackerState;
 - (void)storeHealthCheckTrackerState:(NSDictionary *)healthCheckTrackerState;
 
@@ -6,8 +6,14 @@
 #import "CountlyCommon.h"
 
 @interface CountlyPersistency ()
+{
+    NSInteger _laneCredits[CLYRequestClassCount];
+}
 @property (nonatomic) NSMutableArray* queuedRequests;
-@property (nonatomic) NSMutableArray* recordedEvents;
+@property (nonatomic) NSMutableArray<NSNumber *>* queuedRequestClasses;
+@property (nonatomic) NSString* requestInFlight;
+@property (nonatomic) CountlyEventArena* eventArena;
+@property (nonatomic) CountlyJSONWriter* eventWriter;
 @property (nonatomic) NSMutableDictionary* startedEvents;
 @property (nonatomic) BOOL isQueueBeingModified;
 @end
@@ -23,13 +29,111 @@ NSString* const kCountlyStarRatingStatusKey = @"kCountlyStarRatingStatusKey";
 NSString* const kCountlyNotificationPermissionKey = @"kCountlyNotificationPermissionKey";
 NSString* const kCountlyIsCustomDeviceIDKey = @"kCountlyIsCustomDeviceIDKey";
 NSString* const kCountlyRemoteConfigKey = @"kCountlyRemoteConfigKey";
+NSString* const kCountlyRemoteConfigFetchTimeKey = @"kCountlyRemoteConfigFetchTimeKey";
 NSString* const kCountlyServerConfigPersistencyKey = @"kCountlyServerConfigPersistencyKey";
+NSString* const kCountlyUserDetailsHashesPersistencyKey = @"kCountlyUserDetailsHashesPersistencyKey";
 
 
 NSString* const kCountlyCustomCrashLogFileName = @"CountlyCustomCrash.log";
 
 NSUInteger const kCountlyRequestRemovalLoopLimit = 100;
 
+//NOTE: Relative share of sending turns for each lane, when more than one lane has requests waiting. Control lane is not weighted, as it is always sent in order.
+//NOTE: User details requests are not weighted either, as they share the events lane. See `CountlySchedulingLaneForRequestClass`.
+static const NSInteger kCountlyRequestClassWeights[CLYRequestClassCount] = {0, 8, 0, 4, 1};
+static const NSUInteger kCountlySchedulingLaneCount = 3;
+
+//NOTE: User details and events are sent strictly in the order they were queued, as server processes user properties and events in the order app recorded them.
+//NOTE: So they are scheduled as a single lane, while crash and APM lanes take turns with it.
+static inline CLYRequestClass CountlySchedulingLaneForRequestClass(CLYRequestClass requestClass)
+{
+    return requestClass == CLYRequestClassUserDetails ? CLYRequestClassEvents : requestClass;
+}
+
+CLYRequestClass CountlyRequestClassForQueryString(NSString* queryString)
+{
+    //NOTE: Events are checked first, as events requests may carry a piggybacked session duration
+    __unsafe_unretained NSString* keys[] =
+    {
+        kCountlyQSKeyEvents,
+        kCountlyQSKeySessionBegin, kCountlyQSKeySessionDuration, kCountlyQSKeySessionEnd,
+        kCountlyQSKeyDeviceIDOld, kCountlyQSKeyConsent, kCountlyQSKeyPushTokenSession, kCountlyQSKeyMetrics,
+        kCountlyQSKeyLocation, kCountlyQSKeyLocationCity, kCountlyQSKeyLocationCountry, kCountlyQSKeyLocationIP,
+        kCountlyQSKeyCrash, kCountlyQSKeyUserDetails, kCountlyQSKeyAPM,
+    };
+    static const CLYRequestClass classes[] =
+    {
+        CLYRequestClassEvents,
+        CLYRequestClassControl, CLYRequestClassControl, CLYRequestClassControl,
+        CLYRequestClassControl, CLYRequestClassControl, CLYRequestClassControl, CLYRequestClassControl,
+        CLYRequestClassControl, CLYRequestClassControl, CLYRequestClassControl, CLYRequestClassControl,
+        CLYRequestClassCrash, CLYRequestClassUserDetails, CLYRequestClassAPM,
+    };
+
+    const NSUInteger keyCount = sizeof(classes) / sizeof(classes[0]);
+    NSRange ranges[sizeof(classes) / sizeof(classes[0])];
+    CountlyQueryStringScan(queryString, keys, ranges, keyCount);
+
+    for (NSUInteger i = 0; i < keyCount; i++)
+    {
+        if (ranges[i].location != NSNotFound)
+            return classes[i];
+    }
+
+    //NOTE: Direct requests, attribution and other requests share the events lane
+    return CLYRequestClassEvents;
+}
+
+typedef NS_ENUM(NSUInteger, CLYSupersessionKind)
+{
+    CLYSupersessionKindNone,
+    CLYSupersessionKindConsent,
+    CLYSupersessionKindLocation,
+    CLYSupersessionKindPushToken,
+    CLYSupersessionKindMetrics,
+    CLYSupersessionKindSessionDuration,
+    CLYSupersessionKindSessionEnd,
+};
+
+//NOTE: Control requests which only carry the latest state of something, so a newer one makes earlier queued ones obsolete.
+//NOTE: Session starts and device ID merges are never superseded.
+static CLYSupersessionKind CountlySupersessionKindForQueryString(NSString* queryString)
+{
+    enum { Begin, End, Duration, DeviceIDOld, Consent, PushToken, Metrics, Location, City, Country, IP, KeyCount };
+    __unsafe_unretained NSString* keys[KeyCount] =
+    {
+        kCountlyQSKeySessionBegin, kCountlyQSKeySessionEnd, kCountlyQSKeySessionDuration, kCountlyQSKeyDeviceIDOld,
+        kCountlyQSKeyConsent, kCountlyQSKeyPushTokenSession, kCountlyQSKeyMetrics,
+        kCountlyQSKeyLocation, kCountlyQSKeyLocationCity, kCountlyQSKeyLocationCountry, kCountlyQSKeyLocationIP,
+    };
+
+    NSRange ranges[KeyCount];
+    CountlyQueryStringScan(queryString, keys, ranges, KeyCount);
+
+    if (ranges[Begin].location != NSNotFound || ranges[DeviceIDOld].location != NSNotFound)
+        return CLYSupersessionKindNone;
+
+    if (ranges[End].location != NSNotFound)
+        return CLYSupersessionKindSessionEnd;
+
+    if (ranges[Duration].location != NSNotFound)
+        return CLYSupersessionKindSessionDuration;
+
+    if (ranges[Consent].location != NSNotFound)
+        return CLYSupersessionKindConsent;
+
+    if (ranges[PushToken].location != NSNotFound)
+        return CLYSupersessionKindPushToken;
+
+    if (ranges[Metrics].location != NSNotFound)
+        return CLYSupersessionKindMetrics;
+
+    if (ranges[Location].location != NSNotFound || ranges[City].location != NSNotFound || ranges[Country].location != NSNotFound || ranges[IP].location != NSNotFound)
+        return CLYSupersessionKindLocation;
+
+    return CLYSupersessionKindNone;
+}
+
 static CountlyPersistency* s_sharedInstance = nil;
 static dispatch_once_t onceToken;
 
@@ -61,10 +165,17 @@ static dispatch_once_t onceToken;
         if (!self.queuedRequests)
             self.queuedRequests = NSMutableArray.new;
 
+        self.queuedRequestClasses = [NSMutableArray arrayWithCapacity:self.queuedRequests.count];
+        for (NSString* queryString in self.queuedRequests)
+        {
+            [self.queuedRequestClasses addObject:@(CountlyRequestClassForQueryString(queryString))];
+        }
+
         if (!self.startedEvents)
             self.startedEvents = NSMutableDictionary.new;
 
-        self.recordedEvents = NSMutableArray.new;
+        self.eventArena = CountlyEventArena.new;
+        self.eventWriter = [CountlyJSONWriter.alloc initWithMode:CLYJSONWriterModeURLEscaped];
     }
 
     return self;
@@ -86,8 +197,17 @@ static dispatch_once_t onceToken;
     queryString = [queryString stringByAppendingFormat:@"&%@=%@",
                    kCountlyAppVersionKey, CountlyDeviceInfo.appVersion];
 
+    CLYRequestClass requestClass = CountlyRequestClassForQueryString(queryString);
+
     @synchronized (self)
     {
+        if (requestClass == CLYRequestClassControl)
+            queryString = [self queryStringByCoalescingSupersededRequestsWith:queryString];
+
+        //NOTE: Heartbeat may be merged into a queued events request carrying session duration, then there is nothing left to add
+        if (!queryString)
+            return;
+
         if (self.queuedRequests.count >= self.storedRequestsLimit)
         {
             [self removeOldAgeRequestsFromQueue];
@@ -98,29 +218,246 @@ static dispatch_once_t onceToken;
                 // for example if exceeded count is 136 and our limit is 100 we should remove 100 items
                 // in other case if exceeded count is 36 and out limit is 100 we can only remove 36 items because we have that amount
                 NSUInteger gonnaRemoveSize = MIN(exceededSize, kCountlyRequestRemovalLoopLimit) + 1;
-                CLY_LOG_W(@"[CountlyPersistency] addToQueue, request queue size:[ %lu ] exceeded limit:[ %lu ], will remove first:[ %lu ] request(s)", self.queuedRequests.count, self.storedRequestsLimit, gonnaRemoveSize);
-                NSRange itemsToRemove = NSMakeRange(0, gonnaRemoveSize);
-                [self.queuedRequests removeObjectsInRange:itemsToRemove];
+                CLY_LOG_W(@"[CountlyPersistency] addToQueue, request queue size:[ %lu ] exceeded limit:[ %lu ], will remove:[ %lu ] request(s) from lowest priority lanes", self.queuedRequests.count, self.storedRequestsLimit, gonnaRemoveSize);
+                [self evictQueuedRequests:gonnaRemoveSize];
             }
         }
         [self.queuedRequests addObject:queryString];
+        [self.queuedRequestClasses addObject:@(requestClass)];
+    }
+}
+
+//NOTE: Removes queued control requests made obsolete by given one, looking back until a session boundary or device ID merge.
+//NOTE: Look-back for consent, location, push token and metrics also stops at the first non-control request, so they are never moved after requests queued later than them.
+//NOTE: Session duration heartbeats are merged instead, by adding their durations to the given heartbeat.
+//NOTE: If an events request with piggybacked session duration is found first, heartbeat is merged into it and nil is returned.
+- (NSString *)queryStringByCoalescingSupersededRequestsWith:(NSString *)queryString
+{
+    //NOTE: Session end is kept as a separate request, only heartbeats in between are merged with each other
+    CLYSupersessionKind kind = CountlySupersessionKindForQueryString(queryString);
+    if (kind == CLYSupersessionKindNone || kind == CLYSupersessionKindSessionEnd)
+        return queryString;
+
+    for (NSInteger idx = self.queuedRequests.count - 1; idx >= 0; idx--)
+    {
+        if (self.queuedRequestClasses[idx].unsignedIntegerValue != CLYRequestClassControl)
+        {
+            if (kind != CLYSupersessionKindSessionDuration)
+                break;
+
+            if ([self mergeSessionDurationOf:queryString intoQueuedEventsRequestAtIndex:idx])
+                return nil;
+
+            continue;
+        }
+
+        NSString* queuedQueryString = self.queuedRequests[idx];
+        CLYSupersessionKind queuedKind = CountlySupersessionKindForQueryString(queuedQueryString);
+        if (queuedKind == CLYSupersessionKindNone || queuedKind == CLYSupersessionKindSessionEnd)
+            break;
+
+        if (queuedKind != kind)
+            continue;
+
+        BOOL isSessionDurationMerge = kind == CLYSupersessionKindSessionDuration;
+
+        if (![self isQueryString:queuedQueryString fromSameOriginAs:queryString])
+            break;
+
+        //NOTE: Request being sent can not be merged, as its duration would be counted twice when it succeeds
+        if (queuedQueryString == self.requestInFlight)
+        {
+            if (isSessionDurationMerge)
+                break;
+
+            continue;
+        }
+
+        if (isSessionDurationMerge)
+        {
+            long long duration = [queryString cly_longLongValueForQueryStringKey:kCountlyQSKeySessionDuration] + [queuedQueryString cly_longLongValueForQueryStringKey:kCountlyQSKeySessionDuration];
+            NSRange durationRange = [queryString cly_rangeOfValueForQueryStringKey:kCountlyQSKeySessionDuration];
+            queryString = [queryString stringByReplacingCharactersInRange:durationRange withString:[NSString stringWithFormat:@"%lld", duration]];
+        }
+
+        CLY_LOG_D(@"%s, Queued request is superseded by the new one and removed. Kind: %lu", __FUNCTION__, (unsigned long)queuedKind);
+        [self.queuedRequests removeObjectAtIndex:idx];
+        [self.queuedRequestClasses removeObjectAtIndex:idx];
+    }
+
+    return queryString;
+}
+
+- (BOOL)mergeSessionDurationOf:(NSString *)queryString intoQueuedEventsRequestAtIndex:(NSUInteger)index
+{
+    if (self.queuedRequestClasses[index].unsignedIntegerValue != CLYRequestClassEvents)
+        return NO;
+
+    NSString* queuedQueryString = self.queuedRequests[index];
+    NSRange durationRange = [queuedQueryString cly_rangeOfValueForQueryStringKey:kCountlyQSKeySessionDuration];
+    if (durationRange.location == NSNotFound || queuedQueryString == self.requestInFlight)
+        return NO;
+
+    if (![self isQueryString:queuedQueryString fromSameOriginAs:queryString])
+        return NO;
+
+    long long duration = [queryString cly_longLongValueForQueryStringKey:kCountlyQSKeySessionDuration] + [queuedQueryString cly_longLongValueForQueryStringKey:kCountlyQSKeySessionDuration];
+    self.queuedRequests[index] = [queuedQueryString stringByReplacingCharactersInRange:durationRange withString:[NSString stringWithFormat:@"%lld", duration]];
+
+    CLY_LOG_D(@"%s, Session duration heartbeat is merged into a queued events request", __FUNCTION__);
+    return YES;
+}
+
+- (BOOL)isQueryString:(NSString *)queryString fromSameOriginAs:(NSString *)otherQueryString
+{
+    __unsafe_unretained NSString* keys[] = {kCountlyQSKeyDeviceID, kCountlyQSKeyAppKey};
+    NSRange ranges[2];
+    NSRange otherRanges[2];
+    CountlyQueryStringScan(queryString, keys, ranges, 2);
+    CountlyQueryStringScan(otherQueryString, keys, otherRanges, 2);
+
+    for (NSUInteger i = 0; i < 2; i++)
+    {
+        if (ranges[i].location == NSNotFound || otherRanges[i].location == NSNotFound)
+        {
+            if (ranges[i].location != otherRanges[i].location)
+                return NO;
+
+            continue;
+        }
+
+        if (![self queryString:queryString value:ranges[i] isEqualTo:[otherQueryString substringWithRange:otherRanges[i]]])
+            return NO;
+    }
+
+    return YES;
+}
+
+//NOTE: Sheds requests from the lowest priority lane first, oldest first within a lane. Control requests are evicted last.
+//NOTE: Events requests carrying a piggybacked or merged session duration are evicted as session requests, so session time is not lost with them.
+- (void)evictQueuedRequests:(NSUInteger)count
+{
+    NSMutableIndexSet* indexesToRemove = NSMutableIndexSet.new;
+    NSMutableArray<NSNumber *>* evictionClasses = [NSMutableArray arrayWithCapacity:self.queuedRequestClasses.count];
+    [self.queuedRequestClasses enumerateObjectsUsingBlock:^(NSNumber* queuedRequestClass, NSUInteger idx, BOOL* stop)
+    {
+        BOOL hasSessionDuration = queuedRequestClass.integerValue != CLYRequestClassControl && [self.queuedRequests[idx] cly_rangeOfValueForQueryStringKey:kCountlyQSKeySessionDuration].location != NSNotFound;
+        [evictionClasses addObject:hasSessionDuration ? @(CLYRequestClassControl) : queuedRequestClass];
+    }];
+
+    for (NSInteger requestClass = CLYRequestClassCount - 1; requestClass >= 0 && indexesToRemove.count < count; requestClass--)
+    {
+        [evictionClasses enumerateObjectsUsingBlock:^(NSNumber* evictionClass, NSUInteger idx, BOOL* stop)
+        {
+            if (evictionClass.integerValue != requestClass)
+                return;
+
+            [indexesToRemove addIndex:idx];
+            *stop = indexesToRemove.count >= count;
+        }];
     }
+
+    [self.queuedRequests removeObjectsAtIndexes:indexesToRemove];
+    [self.queuedRequestClasses removeObjectsAtIndexes:indexesToRemove];
+}
+
+- (void)filterQueuedRequestsUsingBlock:(BOOL (^)(NSString* queryString))shouldKeep
+{
+    NSIndexSet* indexesToRemove = [self.queuedRequests indexesOfObjectsPassingTest:^BOOL(NSString* queryString, NSUInteger idx, BOOL* stop)
+    {
+        return !shouldKeep(queryString);
+    }];
+
+    [self.queuedRequests removeObjectsAtIndexes:indexesToRemove];
+    [self.queuedRequestClasses removeObjectsAtIndexes:indexesToRemove];
 }
 
 - (void)removeFromQueue:(NSString *)queryString
 {
     @synchronized (self)
     {
-        if (self.queuedRequests.count)
-            [self.queuedRequests removeObject:queryString inRange:(NSRange){0, 1}];
+        NSUInteger index = [self.queuedRequests indexOfObjectIdenticalTo:queryString];
+        if (index == NSNotFound)
+            index = [self.queuedRequests indexOfObject:queryString];
+
+        if (index == NSNotFound)
+            return;
+
+        if (self.queuedRequests[index] == self.requestInFlight)
+            self.requestInFlight = nil;
+
+        [self.queuedRequests removeObjectAtIndex:index];
+        [self.queuedRequestClasses removeObjectAtIndex:index];
     }
 }
 
-- (NSString *)firstItemInQueue
+//NOTE: Control requests (session, consent, device ID merge, location and push token) act as barriers.
+//NOTE: Nothing queued after a control request is sent before it, and it is not sent before anything queued earlier.
+//NOTE: Heads of other lanes in front of the first barrier take turns with smooth weighted round robin, FIFO within each lane.
+//NOTE: User details and events share a lane, so they are never reordered relative to each other.
+- (NSString *)nextItemInQueue
 {
     @synchronized (self)
     {
-        return self.queuedRequests.firstObject;
+        self.requestInFlight = nil;
+
+        NSUInteger laneHeads[CLYRequestClassCount];
+        for (NSUInteger c = 0; c < CLYRequestClassCount; c++)
+        {
+            laneHeads[c] = NSNotFound;
+        }
+
+        NSUInteger foundLaneCount = 0;
+        for (NSUInteger idx = 0; idx < self.queuedRequestClasses.count && foundLaneCount < kCountlySchedulingLaneCount; idx++)
+        {
+            CLYRequestClass requestClass = CountlySchedulingLaneForRequestClass(self.queuedRequestClasses[idx].unsignedIntegerValue);
+            if (requestClass == CLYRequestClassControl)
+            {
+                if (idx == 0)
+                {
+                    self.requestInFlight = self.queuedRequests.firstObject;
+                    return self.requestInFlight;
+                }
+
+                break;
+            }
+
+            if (laneHeads[requestClass] == NSNotFound)
+            {
+                laneHeads[requestClass] = idx;
+                foundLaneCount++;
+            }
+        }
+
+        if (foundLaneCount == 0)
+            return nil;
+
+        NSInteger totalWeight = 0;
+        NSInteger selectedLane = NSNotFound;
+        for (NSUInteger c = CLYRequestClassControl + 1; c < CLYRequestClassCount; c++)
+        {
+            if (laneHeads[c] == NSNotFound)
+                continue;
+
+            _laneCredits[c] += kCountlyRequestClassWeights[c];
+            totalWeight += kCountlyRequestClassWeights[c];
+
+            if (selectedLane == NSNotFound || _laneCredits[c] > _laneCredits[selectedLane])
+                selectedLane = c;
+        }
+
+        _laneCredits[selectedLane] -= totalWeight;
+
+        self.requestInFlight = self.queuedRequests[laneHeads[selectedLane]];
+        return self.requestInFlight;
+    }
+}
+
+- (BOOL)hasQueuedRequestOfClass:(CLYRequestClass)requestClass
+{
+    @synchronized (self)
+    {
+        return [self.queuedRequestClasses containsObject:@(requestClass)];
     }
 }
 
@@ -129,6 +466,8 @@ static dispatch_once_t onceToken;
     @synchronized (self)
     {
         [self.queuedRequests removeAllObjects];
+        [self.queuedRequestClasses removeAllObjects];
+        memset(_laneCredits, 0, sizeof(_laneCredits));
     }
 }
 
@@ -173,15 +512,18 @@ static dispatch_once_t onceToken;
     {
         self.isQueueBeingModified = YES;
 
+        NSString* currentAppKey = CountlyConnectionManager.sharedInstance.appKey.cly_URLEscaped;
+
         [self.queuedRequests.copy enumerateObjectsUsingBlock:^(NSString* queryString, NSUInteger idx, BOOL* stop)
         {
-            NSString* appKeyInQueryString = [queryString cly_valueForQueryStringKey:kCountlyQSKeyAppKey];
+            NSRange appKeyRange = [queryString cly_rangeOfValueForQueryStringKey:kCountlyQSKeyAppKey];
 
-            if (![appKeyInQueryString isEqualToString:CountlyConnectionManager.sharedInstance.appKey.cly_URLEscaped])
+            if (![self queryString:queryString value:appKeyRange isEqualTo:currentAppKey])
             {
+                NSString* appKeyInQueryString = appKeyRange.location == NSNotFound ? nil : [queryString substringWithRange:appKeyRange];
                 CLY_LOG_D(@"Detected a request with a different app key (%@) in queue and replaced it with current app key.", appKeyInQueryString);
 
-                NSString* currentAppKeyQueryString = [NSString stringWithFormat:@"%@=%@", kCountlyQSKeyAppKey, CountlyConnectionManager.sharedInstance.appKey.cly_URLEscaped];
+                NSString* currentAppKeyQueryString = [NSString stringWithFormat:@"%@=%@", kCountlyQSKeyAppKey, currentAppKey];
                 NSString* differentAppKeyQueryString = [NSString stringWithFormat:@"%@=%@", kCountlyQSKeyAppKey, appKeyInQueryString];
                 NSString * replacedQueryString = [queryString stringByReplacingOccurrencesOfString:differentAppKeyQueryString withString:currentAppKeyQueryString];
                 self.queuedRequests[idx] = replacedQueryString;
@@ -198,25 +540,35 @@ static dispatch_once_t onceToken;
     {
         self.isQueueBeingModified = YES;
 
-        NSPredicate* predicate = [NSPredicate predicateWithBlock:^BOOL(NSString* queryString, NSDictionary<NSString *, id> * bindings)
+        NSString* currentAppKey = CountlyConnectionManager.sharedInstance.appKey.cly_URLEscaped;
+
+        BOOL (^shouldKeep)(NSString *) = ^BOOL(NSString* queryString)
         {
-            NSString* appKeyInQueryString = [queryString cly_valueForQueryStringKey:kCountlyQSKeyAppKey];
+            NSRange appKeyRange = [queryString cly_rangeOfValueForQueryStringKey:kCountlyQSKeyAppKey];
 
-            BOOL isSameAppKey = [appKeyInQueryString isEqualToString:CountlyConnectionManager.sharedInstance.appKey.cly_URLEscaped];
+            BOOL isSameAppKey = [self queryString:queryString value:appKeyRange isEqualTo:currentAppKey];
             if (!isSameAppKey)
             {
-                CLY_LOG_D(@"Detected a request with a different app key (%@) in queue and removed it.", appKeyInQueryString);
+                CLY_LOG_D(@"Detected a request with a different app key (%@) in queue and removed it.", appKeyRange.location == NSNotFound ? nil : [queryString substringWithRange:appKeyRange]);
             }
 
             return isSameAppKey;
-        }];
+        };
 
-        [self.queuedRequests filterUsingPredicate:predicate];
+        [self filterQueuedRequestsUsingBlock:shouldKeep];
 
         self.isQueueBeingModified = NO;
     }
 }
 
+- (BOOL)queryString:(NSString *)queryString value:(NSRange)valueRange isEqualTo:(NSString *)value
+{
+    if (valueRange.location == NSNotFound || valueRange.length != value.length)
+        return NO;
+
+    return [queryString compare:value options:NSLiteralSearch range:valueRange] == NSOrderedSame;
+}
+
 - (void)removeOldAgeRequestsFromQueue
 {
     @synchronized (self)
@@ -224,14 +576,12 @@ static dispatch_once_t onceToken;
         if(self.requestDropAgeHours && self.requestDropAgeHours > 0) {
             self.isQueueBeingModified = YES;
             
-            NSPredicate* predicate = [NSPredicate predicateWithBlock:^BOOL(NSString* queryString, NSDictionary<NSString *, id> * bindings)
-                                      {
+            [self filterQueuedRequestsUsingBlock:^BOOL(NSString* queryString)
+            {
                 BOOL isOldAgeRequest = [self isOldRequestInternal:queryString];
                 return !isOldAgeRequest;
             }];
             
-            [self.queuedRequests filterUsingPredicate:predicate];
-            
             self.isQueueBeingModified = NO;
         }
     }
@@ -248,7 +598,7 @@ static dispatch_once_t onceToken;
 
 -(BOOL)isOldRequestInternal:(NSString *)queryString
 {
-    double requestTimeStamp = [[queryString cly_valueForQueryStringKey:kCountlyQSKeyTimestamp] longLongValue]/1000.0;
+    double requestTimeStamp = [queryString cly_longLongValueForQueryStringKey:kCountlyQSKeyTimestamp]/1000.0;
     double durationInSecods = NSDate.date.timeIntervalSince1970 - requestTimeStamp;
     double durationInHours = (durationInSecods/3600.0);
     BOOL isOldAgeRequest = durationInHours >= self.requestDropAgeHours;
@@ -269,43 +619,73 @@ static dispatch_once_t onceToken;
 
 - (void)recordEvent:(CountlyEvent *)event callback:(CLYRequestCallback)callback
 {
-    @synchronized (self.recordedEvents)
+    @synchronized (self.eventArena)
     {
         if ([CountlyUserDetails.sharedInstance hasUnsyncedChanges])
         {
             [CountlyUserDetails.sharedInstance save];
         }
         
-        [self.recordedEvents addObject:event];
+        [self.eventArena appendEvent:event];
         
-        if (callback != nil || self.recordedEvents.count >= self.eventSendThreshold)
+        if (callback != nil || self.eventArena.count >= self.eventSendThreshold)
         {
             [CountlyConnectionManager.sharedInstance sendEventsWithCallback:callback];
         }
     }
 }
 
+- (void)recordEvents:(NSArray<CountlyEvent *> *)events callback:(CLYRequestCallback)callback
+{
+    if (!events.count)
+        return;
+
+    @synchronized (self.eventArena)
+    {
+        if ([CountlyUserDetails.sharedInstance hasUnsyncedChanges])
+        {
+            [CountlyUserDetails.sharedInstance save];
+        }
+
+        [self.eventArena appendEvents:events];
+
+        if (callback != nil || self.eventArena.count >= self.eventSendThreshold)
+        {
+            [CountlyConnectionManager.sharedInstance sendEventsWithCallback:callback];
+        }
+    }
+}
+
+- (NSMutableArray *)recordedEvents
+{
+    @synchronized (self.eventArena)
+    {
+        return [self.eventArena events];
+    }
+}
+
 - (NSString *)serializedRecordedEvents
 {
-    @synchronized (self.recordedEvents)
+    @synchronized (self.eventArena)
     {
-        if (self.recordedEvents.count == 0)
+        if (self.eventArena.count == 0)
             return nil;
 
-        NSArray *eventDictionaries = [self.recordedEvents valueForKey:@"dictionaryRepresentation"];
+        [self.eventWriter reset];
+        [self.eventArena writeEventsWithWriter:self.eventWriter];
 
-        [self.recordedEvents removeAllObjects];
+        [self.eventArena removeAllEvents];
 
-        return [eventDictionaries cly_JSONify];
+        return self.eventWriter.string;
     }
 }
 
 
 - (void)flushEvents
 {
-    @synchronized (self.recordedEvents)
+    @synchronized (self.eventArena)
     {
-        [self.recordedEvents removeAllObjects];
+        [self.eventArena removeAllEvents];
     }
 }
 
@@ -579,6 +959,9 @@ static dispatch_once_t onceToken;
 {
     [NSUserDefaults.standardUserDefaults setBool:isCustomDeviceID forKey:kCountlyIsCustomDeviceIDKey];
     [NSUserDefaults.standardUserDefaults synchronize];
+
+    //NOTE: Device ID type is a part of cached query essentials
+    [CountlyConnectionManager.sharedInstance invalidateQueryEssentials];
 }
 
 - (NSDictionary *)retrieveRemoteConfig
@@ -597,6 +980,17 @@ static dispatch_once_t onceToken;
     [NSUserDefaults.standardUserDefaults synchronize];
 }
 
+- (NSTimeInterval)retrieveRemoteConfigFetchTime
+{
+    return [NSUserDefaults.standardUserDefaults doubleForKey:kCountlyRemoteConfigFetchTimeKey];
+}
+
+- (void)storeRemoteConfigFetchTime:(NSTimeInterval)fetchTime
+{
+    [NSUserDefaults.standardUserDefaults setDouble:fetchTime forKey:kCountlyRemoteConfigFetchTimeKey];
+    [NSUserDefaults.standardUserDefaults synchronize];
+}
+
 - (NSMutableDictionary *)retrieveServerConfig
 {
     NSDictionary* serverConfig = [NSUserDefaults.standardUserDefaults objectForKey:kCountlyServerConfigPersistencyKey];
@@ -613,6 +1007,25 @@ static dispatch_once_t onceToken;
     [NSUserDefaults.standardUserDefaults synchronize];
 }
 
+- (NSArray *)retrieveUserDetailsAcknowledgedHashes
+{
+    NSArray* acknowledgedHashes = [NSUserDefaults.standardUserDefaults objectForKey:kCountlyUserDetailsHashesPersistencyKey];
+    if (![acknowledgedHashes isKindOfClass:NSArray.class])
+        acknowledgedHashes = NSArray.new;
+
+    return acknowledgedHashes;
+}
+
+- (void)storeUserDetailsAcknowledgedHashes:(NSArray *)acknowledgedHashes
+{
+    if (acknowledgedHashes.count)
+        [NSUserDefaults.standardUserDefaults setObject:acknowledgedHashes forKey:kCountlyUserDetailsHashesPersistencyKey];
+    else
+        [NSUserDefaults.standardUserDefaults removeObjectForKey:kCountlyUserDetailsHashesPersistencyKey];
+
+    [NSUserDefaults.standardUserDefaults synchronize];
+}
+
 - (NSDictionary *)retrieveHealthCheckTrackerState
 {
     NSDictionary* healthCheckTrackerState = [NSUserDefaults.standardUserDefaults objectForKey:kCountlyHealthCheckStatePersistencyKey];
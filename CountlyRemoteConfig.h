@@ -17,6 +17,17 @@
 
 - (NSDictionary<NSString*, CountlyRCData *> *)getAllValues;
 
+/**
+ * Typed accessors for downloaded values, parsed once per download.
+ * @discussion Strings like "true", "42" or "1.5" are converted to the requested type, otherwise default value is returned.
+ * @discussion These are safe to call from any thread and do not allocate, so they can be used in render loops.
+ */
+- (BOOL)boolValueForKey:(NSString *)key defaultValue:(BOOL)defaultValue;
+- (long long)longLongValueForKey:(NSString *)key defaultValue:(long long)defaultValue;
+- (double)doubleValueForKey:(NSString *)key defaultValue:(double)defaultValue;
+- (NSString *)stringValueForKey:(NSString *)key;
+- (id)JSONObjectForKey:(NSString *)key;
+
 - (CountlyRCData *)getValueAndEnroll:(NSString *)key;
 
 - (NSDictionary<NSString*, CountlyRCData *> *)getAllValuesAndEnroll;
@@ -25,6 +36,20 @@
 
 -(void)removeDownloadCallback:(RCDownloadCallback) callback;
 
+/**
+ * Registers a callback to be notified with only the keys added, changed or removed, whenever remote config values are updated.
+ * @discussion Callback is executed on main thread, and is not executed if an update does not change any value.
+ */
+- (void)registerChangeCallback:(RCChangeCallback)callback;
+- (void)removeChangeCallback:(RCChangeCallback)callback;
+
+/**
+ * Registers an observer to be notified when value of given key is added, changed or removed.
+ * @discussion Observer is executed on main thread, with nil value when the key is removed.
+ */
+- (void)registerObserverForKey:(NSString *)key observer:(RCKeyObserver)observer;
+- (void)removeObserverForKey:(NSString *)key observer:(RCKeyObserver)observer;
+
 - (void)downloadKeys:(RCDownloadCallback)completionHandler;
 
 - (void)downloadSpecificKeys:(NSArray *)keys completionHandler:(RCDownloadCallback)completionHandler;
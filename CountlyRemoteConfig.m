@@ -69,6 +69,35 @@
     return [CountlyRemoteConfigInternal.sharedInstance getAllValues];
 }
 
+//NOTE: Typed accessors are not logged, as they are meant to be called on hot paths
+- (BOOL)boolValueForKey:(NSString *)key defaultValue:(BOOL)defaultValue
+{
+    CountlyRemoteConfigInternal* remoteConfig = CountlyRemoteConfigInternal.sharedInstance;
+    return remoteConfig ? [remoteConfig boolValueForKey:key defaultValue:defaultValue] : defaultValue;
+}
+
+- (long long)longLongValueForKey:(NSString *)key defaultValue:(long long)defaultValue
+{
+    CountlyRemoteConfigInternal* remoteConfig = CountlyRemoteConfigInternal.sharedInstance;
+    return remoteConfig ? [remoteConfig longLongValueForKey:key defaultValue:defaultValue] : defaultValue;
+}
+
+- (double)doubleValueForKey:(NSString *)key defaultValue:(double)defaultValue
+{
+    CountlyRemoteConfigInternal* remoteConfig = CountlyRemoteConfigInternal.sharedInstance;
+    return remoteConfig ? [remoteConfig doubleValueForKey:key defaultValue:defaultValue] : defaultValue;
+}
+
+- (NSString *)stringValueForKey:(NSString *)key
+{
+    return [CountlyRemoteConfigInternal.sharedInstance stringValueForKey:key];
+}
+
+- (id)JSONObjectForKey:(NSString *)key
+{
+    return [CountlyRemoteConfigInternal.sharedInstance JSONObjectForKey:key];
+}
+
 - (CountlyRCData *)getValueAndEnroll:(NSString *)key
 {
     CLY_LOG_I(@"%s %@", __FUNCTION__, key);
@@ -105,6 +134,30 @@
     [CountlyRemoteConfigInternal.sharedInstance removeDownloadCallback:callback];
 }
 
+- (void)registerChangeCallback:(RCChangeCallback)callback
+{
+    CLY_LOG_I(@"%s %@", __FUNCTION__, callback);
+    [CountlyRemoteConfigInternal.sharedInstance registerChangeCallback:callback];
+}
+
+- (void)removeChangeCallback:(RCChangeCallback)callback
+{
+    CLY_LOG_I(@"%s %@", __FUNCTION__, callback);
+    [CountlyRemoteConfigInternal.sharedInstance removeChangeCallback:callback];
+}
+
+- (void)registerObserverForKey:(NSString *)key observer:(RCKeyObserver)observer
+{
+    CLY_LOG_I(@"%s %@ %@", __FUNCTION__, key, observer);
+    [CountlyRemoteConfigInternal.sharedInstance registerObserverForKey:key observer:observer];
+}
+
+- (void)removeObserverForKey:(NSString *)key observer:(RCKeyObserver)observer
+{
+    CLY_LOG_I(@"%s %@ %@", __FUNCTION__, key, observer);
+    [CountlyRemoteConfigInternal.sharedInstance removeObserverForKey:key observer:observer];
+}
+
 - (void)downloadKeys:(RCDownloadCallback)completionHandler
 {
     CLY_LOG_I(@"%s %@", __FUNCTION__, completionHandler);
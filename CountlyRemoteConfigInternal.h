@@ -11,6 +11,7 @@
 @property (nonatomic) BOOL isRCAutomaticTriggersEnabled;
 @property (nonatomic) BOOL isRCValueCachingEnabled;
 @property (nonatomic) BOOL enrollABOnRCDownload;
+@property (nonatomic) NSTimeInterval remoteConfigTTL;
 @property (nonatomic, copy) void (^remoteConfigCompletionHandler)(NSError * error);
 @property (nonatomic) NSMutableArray<RCDownloadCallback> *remoteConfigGlobalCallbacks;
 
@@ -28,6 +29,12 @@
 - (CountlyRCData *)getValue:(NSString *)key;
 - (NSDictionary<NSString*, CountlyRCData *> *)getAllValues;
 
+- (BOOL)boolValueForKey:(NSString *)key defaultValue:(BOOL)defaultValue;
+- (long long)longLongValueForKey:(NSString *)key defaultValue:(long long)defaultValue;
+- (double)doubleValueForKey:(NSString *)key defaultValue:(double)defaultValue;
+- (NSString *)stringValueForKey:(NSString *)key;
+- (id)JSONObjectForKey:(NSString *)key;
+
 - (CountlyRCData *)getValueAndEnroll:(NSString *)key;
 - (NSDictionary<NSString*, CountlyRCData *> *)getAllValuesAndEnroll;
 
@@ -46,4 +53,12 @@
 
 - (void)registerDownloadCallback:(RCDownloadCallback) callback;
 - (void)removeDownloadCallback:(RCDownloadCallback) callback;
+
+- (void)registerChangeCallback:(RCChangeCallback)callback;
+- (void)removeChangeCallback:(RCChangeCallback)callback;
+- (void)registerObserverForKey:(NSString *)key observer:(RCKeyObserver)observer;
+- (void)removeObserverForKey:(NSString *)key observer:(RCKeyObserver)observer;
+- (void)removeAllChangeListeners;
+
+- (void)notifyChangesFrom:(NSDictionary<NSString *, CountlyRCData *> *)previousValues to:(NSDictionary<NSString *, CountlyRCData *> *)currentValues;
 @end
@@ -5,6 +5,7 @@
 // Please visit www.count.ly for more information.
 
 #import "CountlyCommon.h"
+#import <stdatomic.h>
 
 NSString* const kCountlyRCKeyFetchRemoteConfig  = @"fetch_remote_config";
 NSString* const kCountlyRCKeyFetchVariant       = @"ab_fetch_variants";
@@ -23,10 +24,30 @@ CLYRequestResult const CLYResponseNetworkIssue  = @"CLYResponseNetworkIssue";
 CLYRequestResult const CLYResponseSuccess       = @"CLYResponseSuccess";
 CLYRequestResult const CLYResponseError         = @"CLYResponseError";
 
+//NOTE: After a failed background refresh, next one is attempted after this fraction of TTL
+static const double kCountlyRemoteConfigRetryTTLRatio = 0.1;
+
+static inline NSTimeInterval CountlyRemoteConfigCurrentTime(void)
+{
+    return CFAbsoluteTimeGetCurrent() + kCFAbsoluteTimeIntervalSince1970;
+}
+
 @interface CountlyRemoteConfigInternal ()
+{
+    _Atomic(BOOL) _isRefreshing;
+    _Atomic(double) _nextRefreshAttemptTime;
+}
 @property (nonatomic) NSDictionary* localCachedVariants;
 @property (nonatomic) NSDictionary<NSString *, CountlyRCData *>* cachedRemoteConfig;
+@property (atomic) CountlyRemoteConfigSnapshot* snapshot;
 @property (nonatomic) NSDictionary<NSString*, CountlyExperimentInformation*> * localCachedExperiments;
+@property (nonatomic) NSMutableArray<RCChangeCallback>* changeCallbacks;
+@property (nonatomic) NSMutableDictionary<NSString *, NSMutableArray<RCKeyObserver> *>* keyObservers;
+@property (nonatomic) NSMutableOrderedSet<NSString *>* pendingEnrollKeys;
+@property (nonatomic) NSMutableOrderedSet<NSString *>* pendingExitKeys;
+@property (nonatomic) NSMutableSet<NSString *>* enrolledKeys;
+@property (nonatomic, weak) CountlyRemoteConfigSnapshot* enrolledSnapshot;
+@property (nonatomic) BOOL isABFlushScheduled;
 @end
 
 @implementation CountlyRemoteConfigInternal
@@ -46,12 +67,17 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
 {
     if (self = [super init])
     {
-        self.cachedRemoteConfig = [CountlyPersistency.sharedInstance retrieveRemoteConfig];
-        if(!self.cachedRemoteConfig) {
-            self.cachedRemoteConfig = NSMutableDictionary.new;
-        }
+        self.snapshot = [CountlyRemoteConfigSnapshot.alloc initWithValues:[CountlyPersistency.sharedInstance retrieveRemoteConfig]
+                                                                 fetchTime:[CountlyPersistency.sharedInstance retrieveRemoteConfigFetchTime]];
+        atomic_init(&_isRefreshing, NO);
+        atomic_init(&_nextRefreshAttemptTime, 0);
         
         self.remoteConfigGlobalCallbacks = [[NSMutableArray alloc] init];
+        self.changeCallbacks = NSMutableArray.new;
+        self.keyObservers = NSMutableDictionary.new;
+        self.pendingEnrollKeys = NSMutableOrderedSet.new;
+        self.pendingExitKeys = NSMutableOrderedSet.new;
+        self.enrolledKeys = NSMutableSet.new;
         
         self.localCachedExperiments = NSMutableDictionary.new;
     }
@@ -61,6 +87,87 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
 
 #pragma mark ---
 
+//NOTE: Values are read from arbitrary threads, so each update swaps in a new immutable snapshot instead of mutating shared state
+- (NSDictionary<NSString *, CountlyRCData *> *)cachedRemoteConfig
+{
+    return self.snapshot.values;
+}
+
+//NOTE: Partial updates keep the fetch time of the previous snapshot, only full downloads make it fresh
+- (void)setCachedRemoteConfig:(NSDictionary<NSString *, CountlyRCData *> *)cachedRemoteConfig
+{
+    self.snapshot = [CountlyRemoteConfigSnapshot.alloc initWithValues:cachedRemoteConfig fetchTime:self.snapshot.fetchTime];
+}
+
+- (void)setFetchedRemoteConfig:(NSDictionary<NSString *, CountlyRCData *> *)remoteConfig
+{
+    [self setRemoteConfig:remoteConfig fetchTime:CountlyRemoteConfigCurrentTime()];
+}
+
+- (void)setRemoteConfig:(NSDictionary<NSString *, CountlyRCData *> *)remoteConfig fetchTime:(NSTimeInterval)fetchTime
+{
+    self.snapshot = [CountlyRemoteConfigSnapshot.alloc initWithValues:remoteConfig fetchTime:fetchTime];
+    [CountlyPersistency.sharedInstance storeRemoteConfigFetchTime:fetchTime];
+}
+
+- (BOOL)isRemoteConfigStale
+{
+    return self.remoteConfigTTL > 0 && [self.snapshot isStaleAt:CountlyRemoteConfigCurrentTime() TTL:self.remoteConfigTTL];
+}
+
+//NOTE: Stale-while-revalidate: cached values are returned right away, and a single background refresh is started if they are stale
+//NOTE: As this is called on every read, preconditions are checked before dispatching anything
+- (void)refreshRemoteConfigIfStale
+{
+    if (![self isRemoteConfigStale])
+        return;
+
+    if (CountlyRemoteConfigCurrentTime() < atomic_load_explicit(&_nextRefreshAttemptTime, memory_order_relaxed))
+        return;
+
+    if (![self canRefreshRemoteConfig])
+        return;
+
+    if (atomic_exchange(&_isRefreshing, YES))
+        return;
+
+    dispatch_async(dispatch_get_main_queue(), ^
+    {
+        //NOTE: Preconditions may have changed until main queue is reached
+        if (![self canRefreshRemoteConfig])
+        {
+            [self postponeNextRefreshAttempt];
+            atomic_store(&self->_isRefreshing, NO);
+            return;
+        }
+
+        CLY_LOG_D(@"%s, Remote config is stale, refreshing in background...", __FUNCTION__);
+
+        [self downloadValuesForKeys:nil omitKeys:nil completionHandler:^(CLYRequestResult response, NSError* error, BOOL fullValueUpdate, NSDictionary<NSString *, CountlyRCData *>* downloadedValues)
+        {
+            if (error)
+                [self postponeNextRefreshAttempt];
+
+            atomic_store(&self->_isRefreshing, NO);
+        }];
+    });
+}
+
+- (BOOL)canRefreshRemoteConfig
+{
+    return CountlyConsentManager.sharedInstance.consentForRemoteConfig &&
+           !CountlyDeviceInfo.sharedInstance.isDeviceIDTemporary &&
+           CountlyServerConfig.sharedInstance.networkingEnabled;
+}
+
+- (void)postponeNextRefreshAttempt
+{
+    NSTimeInterval retryInterval = self.remoteConfigTTL * kCountlyRemoteConfigRetryTTLRatio * self.snapshot.refreshJitter;
+    atomic_store_explicit(&_nextRefreshAttemptTime, CountlyRemoteConfigCurrentTime() + retryInterval, memory_order_relaxed);
+}
+
+#pragma mark ---
+
 - (void)startRemoteConfig
 {
     if (!self.isRCAutomaticTriggersEnabled)
@@ -79,8 +186,10 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
         if (!error)
         {
             CLY_LOG_D(@"%s, Fetching remote config on start is successful. %@", __FUNCTION__, remoteConfig);
-            self.cachedRemoteConfig = [self createRCMeta:remoteConfig];
+            NSDictionary* previousValues = self.cachedRemoteConfig;
+            [self setFetchedRemoteConfig:[self createRCMeta:remoteConfig]];
             [CountlyPersistency.sharedInstance storeRemoteConfig:self.cachedRemoteConfig];
+            [self notifyChangesFrom:previousValues to:self.cachedRemoteConfig];
             
         }
         else
@@ -103,6 +212,12 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
     
     if (CountlyDeviceInfo.sharedInstance.isDeviceIDTemporary)
         return;
+
+    if (self.remoteConfigTTL > 0 && ![self isRemoteConfigStale])
+    {
+        CLY_LOG_D(@"%s, Cached remote config is still fresh, skipping automatic download.", __FUNCTION__);
+        return;
+    }
     
     CLY_LOG_D(@"Fetching remote config on start...");
     
@@ -129,10 +244,11 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
         if (!error)
         {
             CLY_LOG_D(@"%s, Fetching remote config manually is successful. %@", __FUNCTION__, remoteConfig);
+            NSDictionary* previousValues = self.cachedRemoteConfig;
             NSDictionary* remoteConfigMeta = [self createRCMeta:remoteConfig];
             if (!keys && !omitKeys)
             {
-                self.cachedRemoteConfig = remoteConfigMeta;
+                [self setFetchedRemoteConfig:remoteConfigMeta];
             }
             else
             {
@@ -142,8 +258,7 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
             }
             
             [CountlyPersistency.sharedInstance storeRemoteConfig:self.cachedRemoteConfig];
-            
-            
+            [self notifyChangesFrom:previousValues to:self.cachedRemoteConfig];
         }
         else
         {
@@ -157,6 +272,8 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
 
 - (id)remoteConfigValueForKey:(NSString *)key
 {
+    [self refreshRemoteConfigIfStale];
+
     CountlyRCData* countlyRCValue = self.cachedRemoteConfig[key];
     if (countlyRCValue) {
         return countlyRCValue.value;
@@ -180,8 +297,10 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
 -(void)clearAll
 {
     CLY_LOG_D(@"'clearAll' will erase all remote config values.");
-    self.cachedRemoteConfig = NSMutableDictionary.new;
+    NSDictionary* previousValues = self.cachedRemoteConfig;
+    [self setRemoteConfig:NSDictionary.new fetchTime:0];
     [CountlyPersistency.sharedInstance storeRemoteConfig:self.cachedRemoteConfig];
+    [self notifyChangesFrom:previousValues to:self.cachedRemoteConfig];
 }
 
 #pragma mark ---
@@ -298,6 +417,8 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
 
 - (CountlyRCData *)getValue:(NSString *)key
 {
+    [self refreshRemoteConfigIfStale];
+
     CountlyRCData *countlyRCData = self.cachedRemoteConfig[key];
     if (!countlyRCData) {
         countlyRCData = [[CountlyRCData alloc] initWithValue:nil isCurrentUsersData:YES];
@@ -307,9 +428,41 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
 
 - (NSDictionary<NSString*, CountlyRCData *> *)getAllValues
 {
+    [self refreshRemoteConfigIfStale];
+
     return self.cachedRemoteConfig;
 }
 
+- (BOOL)boolValueForKey:(NSString *)key defaultValue:(BOOL)defaultValue
+{
+    [self refreshRemoteConfigIfStale];
+    return [self.snapshot boolValueForKey:key defaultValue:defaultValue];
+}
+
+- (long long)longLongValueForKey:(NSString *)key defaultValue:(long long)defaultValue
+{
+    [self refreshRemoteConfigIfStale];
+    return [self.snapshot longLongValueForKey:key defaultValue:defaultValue];
+}
+
+- (double)doubleValueForKey:(NSString *)key defaultValue:(double)defaultValue
+{
+    [self refreshRemoteConfigIfStale];
+    return [self.snapshot doubleValueForKey:key defaultValue:defaultValue];
+}
+
+- (NSString *)stringValueForKey:(NSString *)key
+{
+    [self refreshRemoteConfigIfStale];
+    return [self.snapshot stringValueForKey:key];
+}
+
+- (id)JSONObjectForKey:(NSString *)key
+{
+    [self refreshRemoteConfigIfStale];
+    return [self.snapshot JSONObjectForKey:key];
+}
+
 - (CountlyRCData *)getValueAndEnroll:(NSString *)key
 {
     CountlyRCData *countlyRCData = [self getValue:key];
@@ -341,10 +494,36 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
     if (CountlyDeviceInfo.sharedInstance.isDeviceIDTemporary)
         return;
     
+    if (!keys.count)
+    {
+        //NOTE: Enrolling into all tests is not batched, pending ones are sent first to keep the order
+        [self flushPendingABRequests];
+        CLY_LOG_D(@"Entolling in AB Tests...");
+        [CountlyConnectionManager.sharedInstance sendEnrollABRequestForKeys:keys];
+        return;
+    }
     
-    CLY_LOG_D(@"Entolling in AB Tests...");
+    @synchronized (self.pendingEnrollKeys)
+    {
+        //NOTE: Keys already enrolled for current values are skipped, as reading same flags repeatedly is common
+        if (self.enrolledSnapshot != self.snapshot)
+        {
+            [self.enrolledKeys removeAllObjects];
+            self.enrolledSnapshot = self.snapshot;
+        }
+        
+        for (NSString* key in keys)
+        {
+            if ([self.enrolledKeys containsObject:key])
+                continue;
+            
+            [self.enrolledKeys addObject:key];
+            [self.pendingExitKeys removeObject:key];
+            [self.pendingEnrollKeys addObject:key];
+        }
+    }
     
-    [CountlyConnectionManager.sharedInstance sendEnrollABRequestForKeys:keys];
+    [self schedulePendingABRequestsFlush];
 }
 
 - (void)exitABTestsForKeys:(NSArray *)keys
@@ -355,10 +534,74 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
     if (CountlyDeviceInfo.sharedInstance.isDeviceIDTemporary)
         return;
     
+    if (!keys.count)
+    {
+        @synchronized (self.pendingEnrollKeys)
+        {
+            [self.enrolledKeys removeAllObjects];
+        }
+        
+        [self flushPendingABRequests];
+        CLY_LOG_D(@"Exiting AB Tests...");
+        [CountlyConnectionManager.sharedInstance sendExitABRequestForKeys:keys];
+        return;
+    }
+    
+    @synchronized (self.pendingEnrollKeys)
+    {
+        for (NSString* key in keys)
+        {
+            [self.enrolledKeys removeObject:key];
+            [self.pendingEnrollKeys removeObject:key];
+            [self.pendingExitKeys addObject:key];
+        }
+    }
+    
+    [self schedulePendingABRequestsFlush];
+}
+
+- (void)schedulePendingABRequestsFlush
+{
+    @synchronized (self.pendingEnrollKeys)
+    {
+        if (self.isABFlushScheduled)
+            return;
+        
+        self.isABFlushScheduled = YES;
+    }
+    
+    //NOTE: All enrollments and exits requested until next main queue turn are sent as one request each
+    dispatch_async(dispatch_get_main_queue(), ^
+    {
+        [self flushPendingABRequests];
+    });
+}
+
+- (void)flushPendingABRequests
+{
+    NSArray* enrollKeys = nil;
+    NSArray* exitKeys = nil;
+    
+    @synchronized (self.pendingEnrollKeys)
+    {
+        self.isABFlushScheduled = NO;
+        enrollKeys = self.pendingEnrollKeys.array;
+        exitKeys = self.pendingExitKeys.array;
+        [self.pendingEnrollKeys removeAllObjects];
+        [self.pendingExitKeys removeAllObjects];
+    }
     
-    CLY_LOG_D(@"Exiting AB Tests...");
+    if (exitKeys.count)
+    {
+        CLY_LOG_D(@"Exiting AB Tests for %lu keys...", (unsigned long)exitKeys.count);
+        [CountlyConnectionManager.sharedInstance sendExitABRequestForKeys:exitKeys];
+    }
     
-    [CountlyConnectionManager.sharedInstance sendExitABRequestForKeys:keys];
+    if (enrollKeys.count)
+    {
+        CLY_LOG_D(@"Entolling in AB Tests for %lu keys...", (unsigned long)enrollKeys.count);
+        [CountlyConnectionManager.sharedInstance sendEnrollABRequestForKeys:enrollKeys];
+    }
 }
 
 - (void)downloadValuesForKeys:(NSArray *)keys omitKeys:(NSArray *)omitKeys completionHandler:(RCDownloadCallback)completionHandler
@@ -379,10 +622,11 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
         if (!error)
         {
             CLY_LOG_D(@"%s, fetching remote config is successful. %@", __FUNCTION__, remoteConfig);
+            NSDictionary* previousValues = self.cachedRemoteConfig;
             if (!keys && !omitKeys)
             {
                 fullValueUpdate = true;
-                self.cachedRemoteConfig = remoteConfigMeta;
+                [self setFetchedRemoteConfig:remoteConfigMeta];
             }
             else
             {
@@ -392,8 +636,7 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
             }
             
             [CountlyPersistency.sharedInstance storeRemoteConfig:self.cachedRemoteConfig];
-            
-            
+            [self notifyChangesFrom:previousValues to:self.cachedRemoteConfig];
         }
         else
         {
@@ -429,13 +672,149 @@ CLYRequestResult const CLYResponseError         = @"CLYResponseError";
 - (void)updateMetaStateToCache
 {
     CLY_LOG_D(@"'updateMetaStateToCache' will cache all remote config values.");
+
+    //NOTE: Values of the current snapshot may be read from other threads, so they are copied instead of being modified in place
+    NSMutableDictionary<NSString *, CountlyRCData *>* previousUsersRemoteConfig = NSMutableDictionary.new;
     [self.cachedRemoteConfig enumerateKeysAndObjectsUsingBlock:^(NSString * key, CountlyRCData * countlyRCMeta, BOOL * stop)
      {
-        countlyRCMeta.isCurrentUsersData = NO;
-        
+        previousUsersRemoteConfig[key] = [[CountlyRCData alloc] initWithValue:countlyRCMeta.value isCurrentUsersData:NO];
     }];
+
+    //NOTE: Values cached for a previous user should be refreshed on next read
+    [self setRemoteConfig:previousUsersRemoteConfig fetchTime:0];
     
-    [CountlyPersistency.sharedInstance storeRemoteConfig:self.cachedRemoteConfig];
+    [CountlyPersistency.sharedInstance storeRemoteConfig:previousUsersRemoteConfig];
+}
+
+#pragma mark ---
+
+- (void)registerChangeCallback:(RCChangeCallback)callback
+{
+    if (!callback)
+        return;
+
+    @synchronized (self.changeCallbacks)
+    {
+        [self.changeCallbacks addObject:callback];
+    }
+}
+
+- (void)removeChangeCallback:(RCChangeCallback)callback
+{
+    @synchronized (self.changeCallbacks)
+    {
+        [self.changeCallbacks removeObject:callback];
+    }
+}
+
+- (void)registerObserverForKey:(NSString *)key observer:(RCKeyObserver)observer
+{
+    if (!key.length || !observer)
+        return;
+
+    @synchronized (self.keyObservers)
+    {
+        if (!self.keyObservers[key])
+            self.keyObservers[key] = NSMutableArray.new;
+
+        [self.keyObservers[key] addObject:observer];
+    }
+}
+
+- (void)removeObserverForKey:(NSString *)key observer:(RCKeyObserver)observer
+{
+    if (!key.length)
+        return;
+
+    @synchronized (self.keyObservers)
+    {
+        [self.keyObservers[key] removeObject:observer];
+        if (!self.keyObservers[key].count)
+            [self.keyObservers removeObjectForKey:key];
+    }
+}
+
+- (void)removeAllChangeListeners
+{
+    @synchronized (self.changeCallbacks)
+    {
+        [self.changeCallbacks removeAllObjects];
+    }
+
+    @synchronized (self.keyObservers)
+    {
+        [self.keyObservers removeAllObjects];
+    }
+}
+
+- (void)notifyChangesFrom:(NSDictionary<NSString *, CountlyRCData *> *)previousValues to:(NSDictionary<NSString *, CountlyRCData *> *)currentValues
+{
+    NSMutableDictionary<NSString *, CountlyRCData *>* addedValues = NSMutableDictionary.new;
+    NSMutableDictionary<NSString *, CountlyRCData *>* changedValues = NSMutableDictionary.new;
+    NSMutableArray<NSString *>* removedKeys = NSMutableArray.new;
+
+    [currentValues enumerateKeysAndObjectsUsingBlock:^(NSString* key, CountlyRCData* data, BOOL* stop)
+    {
+        CountlyRCData* previousData = previousValues[key];
+        if (!previousData)
+            addedValues[key] = data;
+        else if (previousData.value != data.value && ![previousData.value isEqual:data.value])
+            changedValues[key] = data;
+    }];
+
+    [previousValues enumerateKeysAndObjectsUsingBlock:^(NSString* key, CountlyRCData* data, BOOL* stop)
+    {
+        if (!currentValues[key])
+            [removedKeys addObject:key];
+    }];
+
+    if (!addedValues.count && !changedValues.count && !removedKeys.count)
+        return;
+
+    CLY_LOG_D(@"%s, Remote config values changed. added: %lu, changed: %lu, removed: %lu", __FUNCTION__, (unsigned long)addedValues.count, (unsigned long)changedValues.count, (unsigned long)removedKeys.count);
+
+    NSArray<RCChangeCallback>* changeCallbacks = nil;
+    @synchronized (self.changeCallbacks)
+    {
+        changeCallbacks = self.changeCallbacks.copy;
+    }
+
+    NSMutableArray* keyNotifications = NSMutableArray.new;
+    @synchronized (self.keyObservers)
+    {
+        void (^collect)(NSString*, CountlyRCData*) = ^(NSString* key, CountlyRCData* data)
+        {
+            for (RCKeyObserver observer in self.keyObservers[key])
+            {
+                [keyNotifications addObject:^{ observer(key, data); }];
+            }
+        };
+
+        [addedValues enumerateKeysAndObjectsUsingBlock:^(NSString* key, CountlyRCData* data, BOOL* stop) { collect(key, data); }];
+        [changedValues enumerateKeysAndObjectsUsingBlock:^(NSString* key, CountlyRCData* data, BOOL* stop) { collect(key, data); }];
+        for (NSString* key in removedKeys)
+        {
+            collect(key, nil);
+        }
+    }
+
+    void (^notify)(void) = ^
+    {
+        for (RCChangeCallback callback in changeCallbacks)
+        {
+            callback(addedValues, changedValues, removedKeys);
+        }
+
+        for (dispatch_block_t keyNotification in keyNotifications)
+        {
+            keyNotification();
+        }
+    };
+
+    if (NSThread.isMainThread)
+        notify();
+    else
+        dispatch_async(dispatch_get_main_queue(), notify);
 }
 
 -(void)registerDownloadCallback:(RCDownloadCallback) callback
@@ -0,0 +1,34 @@
+// CountlyRemoteConfigSnapshot.h
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import <Foundation/Foundation.h>
+
+@class CountlyRCData;
+
+NS_ASSUME_NONNULL_BEGIN
+
+//NOTE: Immutable view of downloaded remote config values, replaced as a whole on each download.
+//NOTE: Typed values are parsed once when the snapshot is created, so typed reads do not allocate.
+@interface CountlyRemoteConfigSnapshot : NSObject
+
+@property (nonatomic, readonly) NSDictionary<NSString *, CountlyRCData *>* values;
+@property (nonatomic, readonly) NSTimeInterval fetchTime;
+@property (nonatomic, readonly) double refreshJitter;
+
+- (instancetype)initWithValues:(NSDictionary<NSString *, CountlyRCData *> *)values;
+- (instancetype)initWithValues:(NSDictionary<NSString *, CountlyRCData *> *)values fetchTime:(NSTimeInterval)fetchTime;
+
+- (BOOL)isStaleAt:(NSTimeInterval)time TTL:(NSTimeInterval)TTL;
+
+- (BOOL)boolValueForKey:(NSString *)key defaultValue:(BOOL)defaultValue;
+- (long long)longLongValueForKey:(NSString *)key defaultValue:(long long)defaultValue;
+- (double)doubleValueForKey:(NSString *)key defaultValue:(double)defaultValue;
+- (NSString * _Nullable)stringValueForKey:(NSString *)key;
+- (id _Nullable)JSONObjectForKey:(NSString *)key;
+
+@end
+
+NS_ASSUME_NONNULL_END
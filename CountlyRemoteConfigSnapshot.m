@@ -0,0 +1,179 @@
+// CountlyRemoteConfigSnapshot.m
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import "CountlyCommon.h"
+
+@interface CountlyRemoteConfigTypedValue : NSObject
+{
+@public
+    BOOL _hasBool;
+    BOOL _hasLongLong;
+    BOOL _hasDouble;
+    BOOL _boolValue;
+    long long _longLongValue;
+    double _doubleValue;
+    NSString* _stringValue;
+    id _JSONObject;
+}
+- (instancetype)initWithValue:(id)value;
+@end
+
+@implementation CountlyRemoteConfigTypedValue
+
+- (instancetype)initWithValue:(id)value
+{
+    if (self = [super init])
+    {
+        if ([value isKindOfClass:NSNumber.class])
+        {
+            [self parseNumber:value];
+            _stringValue = [value stringValue];
+        }
+        else if ([value isKindOfClass:NSString.class])
+        {
+            _stringValue = value;
+            [self parseString:value];
+        }
+        else if ([value isKindOfClass:NSDictionary.class] || [value isKindOfClass:NSArray.class])
+        {
+            _JSONObject = value;
+            _stringValue = [[NSString alloc] initWithData:[NSJSONSerialization dataWithJSONObject:value options:0 error:nil] encoding:NSUTF8StringEncoding];
+        }
+    }
+
+    return self;
+}
+
+- (void)parseNumber:(NSNumber *)number
+{
+    _hasBool = _hasLongLong = _hasDouble = YES;
+    _boolValue = number.boolValue;
+    _longLongValue = number.longLongValue;
+    _doubleValue = number.doubleValue;
+}
+
+- (void)parseString:(NSString *)string
+{
+    NSString* trimmed = [string stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceAndNewlineCharacterSet];
+    if (!trimmed.length)
+        return;
+
+    NSString* lowercase = trimmed.lowercaseString;
+    if ([lowercase isEqualToString:@"true"] || [lowercase isEqualToString:@"yes"])
+    {
+        _hasBool = YES;
+        _boolValue = YES;
+        return;
+    }
+
+    if ([lowercase isEqualToString:@"false"] || [lowercase isEqualToString:@"no"])
+    {
+        _hasBool = YES;
+        _boolValue = NO;
+        return;
+    }
+
+    unichar first = [trimmed characterAtIndex:0];
+    if (first == '{' || first == '[')
+    {
+        id JSONObject = [NSJSONSerialization JSONObjectWithData:[trimmed cly_dataUTF8] options:0 error:nil];
+        if ([JSONObject isKindOfClass:NSDictionary.class] || [JSONObject isKindOfClass:NSArray.class])
+            _JSONObject = JSONObject;
+        return;
+    }
+
+    NSScanner* scanner = [NSScanner scannerWithString:trimmed];
+    scanner.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+    long long longLongValue = 0;
+    if ([scanner scanLongLong:&longLongValue] && scanner.isAtEnd)
+    {
+        [self parseNumber:@(longLongValue)];
+        return;
+    }
+
+    scanner.scanLocation = 0;
+    double doubleValue = 0;
+    if ([scanner scanDouble:&doubleValue] && scanner.isAtEnd)
+    {
+        [self parseNumber:@(doubleValue)];
+    }
+}
+
+@end
+
+
+@interface CountlyRemoteConfigSnapshot ()
+@property (nonatomic) NSDictionary<NSString *, CountlyRCData *>* values;
+@property (nonatomic) NSDictionary<NSString *, CountlyRemoteConfigTypedValue *>* typedValues;
+@property (nonatomic) NSTimeInterval fetchTime;
+@property (nonatomic) double refreshJitter;
+@end
+
+//NOTE: Snapshots become stale somewhere between 80% and 100% of TTL, so devices fetched at the same time do not refresh together
+static const double kCountlyRemoteConfigMinRefreshJitter = 0.8;
+
+@implementation CountlyRemoteConfigSnapshot
+
+- (instancetype)initWithValues:(NSDictionary<NSString *, CountlyRCData *> *)values
+{
+    return [self initWithValues:values fetchTime:0];
+}
+
+- (instancetype)initWithValues:(NSDictionary<NSString *, CountlyRCData *> *)values fetchTime:(NSTimeInterval)fetchTime
+{
+    if (self = [super init])
+    {
+        self.values = values ? [values copy] : @{};
+        self.fetchTime = fetchTime;
+        self.refreshJitter = kCountlyRemoteConfigMinRefreshJitter + (1.0 - kCountlyRemoteConfigMinRefreshJitter) * arc4random_uniform(UINT32_MAX) / UINT32_MAX;
+
+        NSMutableDictionary* typedValues = [NSMutableDictionary dictionaryWithCapacity:self.values.count];
+        [self.values enumerateKeysAndObjectsUsingBlock:^(NSString* key, CountlyRCData* data, BOOL* stop)
+        {
+            typedValues[key] = [CountlyRemoteConfigTypedValue.alloc initWithValue:data.value];
+        }];
+        self.typedValues = typedValues.copy;
+    }
+
+    return self;
+}
+
+- (BOOL)isStaleAt:(NSTimeInterval)time TTL:(NSTimeInterval)TTL
+{
+    return time < self.fetchTime || time >= self.fetchTime + TTL * self.refreshJitter;
+}
+
+- (BOOL)boolValueForKey:(NSString *)key defaultValue:(BOOL)defaultValue
+{
+    CountlyRemoteConfigTypedValue* typedValue = self.typedValues[key];
+    return typedValue && typedValue->_hasBool ? typedValue->_boolValue : defaultValue;
+}
+
+- (long long)longLongValueForKey:(NSString *)key defaultValue:(long long)defaultValue
+{
+    CountlyRemoteConfigTypedValue* typedValue = self.typedValues[key];
+    return typedValue && typedValue->_hasLongLong ? typedValue->_longLongValue : defaultValue;
+}
+
+- (double)doubleValueForKey:(NSString *)key defaultValue:(double)defaultValue
+{
+    CountlyRemoteConfigTypedValue* typedValue = self.typedValues[key];
+    return typedValue && typedValue->_hasDouble ? typedValue->_doubleValue : defaultValue;
+}
+
+- (NSString *)stringValueForKey:(NSString *)key
+{
+    CountlyRemoteConfigTypedValue* typedValue = self.typedValues[key];
+    return typedValue ? typedValue->_stringValue : nil;
+}
+
+- (id)JSONObjectForKey:(NSString *)key
+{
+    CountlyRemoteConfigTypedValue* typedValue = self.typedValues[key];
+    return typedValue ? typedValue->_JSONObject : nil;
+}
+
+@end
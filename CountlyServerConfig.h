@@ -6,6 +6,8 @@
 
 #import <Foundation/Foundation.h>
 
+@class CountlyKeyMatcher;
+
 extern NSString* const kCountlySCKeySC;
 
 @interface CountlyServerConfig : NSObject
@@ -52,6 +54,10 @@ extern NSString* const kCountlySCKeySC;
 - (BOOL)shouldRecordEvent:(NSString *)eventKey;
 - (BOOL)shouldRecordUserProperty:(NSString *)propertyKey;
 - (NSDictionary *)filterSegmentation:(NSDictionary *)segmentation eventKey:(NSString *)eventKey;
+- (NSDictionary *)filterSegmentation:(NSDictionary *)segmentation eventKey:(NSString *)eventKey eventFilter:(CountlyKeyMatcher *)eventFilter;
+- (CountlyKeyMatcher *)eventSegmentationFilterForEventKey:(NSString *)eventKey;
+- (BOOL)hasGlobalSegmentationFilter;
+- (BOOL)isSegmentationKey:(NSString *)key allowedWithEventFilter:(CountlyKeyMatcher *)eventFilter;
 - (BOOL)isJourneyTriggerEvent:(NSString *)eventKey;
 - (NSInteger)userPropertyCacheLimit;
 
@@ -7,7 +7,6 @@
 #import "CountlyCommon.h"
 
 @interface CountlyServerConfig () {
-    NSTimer *_requestTimer;
 }
 @property (nonatomic) BOOL trackingEnabled;
 @property (nonatomic) BOOL networkingEnabled;
@@ -43,16 +42,16 @@
 
 @property (nonatomic) NSInteger requestTimeoutDuration;
 
-@property (nonatomic) NSSet<NSString *> *eventFilterSet;
+@property (nonatomic) CountlyKeyMatcher *eventFilter;
 @property (nonatomic) BOOL eventFilterIsWhitelist;
-@property (nonatomic) NSSet<NSString *> *userPropertyFilterSet;
+@property (nonatomic) CountlyKeyMatcher *userPropertyFilter;
 @property (nonatomic) BOOL userPropertyFilterIsWhitelist;
 @property (nonatomic) NSInteger userPropertyCacheLimit;
-@property (nonatomic) NSSet<NSString *> *segmentationFilterSet;
+@property (nonatomic) CountlyKeyMatcher *segmentationFilter;
 @property (nonatomic) BOOL segmentationFilterIsWhitelist;
-@property (nonatomic) NSDictionary<NSString *, NSSet<NSString *> *> *eventSegmentationFilterMap;
+@property (nonatomic) CountlyKeyMatcher *eventSegmentationFilters;
 @property (nonatomic) BOOL eventSegmentationFilterIsWhitelist;
-@property (nonatomic) NSSet<NSString *> *journeyTriggerEvents;
+@property (nonatomic) CountlyKeyMatcher *journeyTriggerEvents;
 
 @property (nonatomic) NSInteger version;
 @property (nonatomic) long long timestamp;
@@ -132,7 +131,6 @@ static dispatch_once_t onceToken;
         _timestamp = 0;
         _version = 0;
         _currentServerConfigUpdateInterval = 4;
-        _requestTimer = nil;
         _serverConfigUpdatesDisabled = NO;
         _requestTimeoutDuration = 30;
         [self setDefaultValues];
@@ -149,11 +147,7 @@ static dispatch_once_t onceToken;
     _serverConfigUpdatesDisabled = NO;
     _requestTimeoutDuration = 30;
     _lastFetchTimestamp = 0;
-    if (_requestTimer)
-    {
-        [_requestTimer invalidate];
-        _requestTimer = nil;
-    }
+    [CountlyTimerWheel.sharedInstance cancelTaskWithIdentifier:kCountlyTimerTaskServerConfig];
     [self setDefaultValues];
     onceToken = 0;
     s_sharedInstance = nil;
@@ -421,6 +415,7 @@ static dispatch_once_t onceToken;
     [self setIntegerProperty:&_userPropertyCacheLimit fromDictionary:dictionary key:kRUserPropertyCacheLimit logString:logString];
 
     [self updateListingFilters:dictionary logString:logString];
+    [CountlyEventRouter.sharedInstance invalidate];
 
     // Update the config dictionary with cleaned values
     serverConfig[kRConfig] = dictionary;
@@ -514,13 +509,10 @@ static dispatch_once_t onceToken;
 #endif
     CountlyCrashReporter.sharedInstance.crashLogLimit = config.sdkInternalLimits.getMaxBreadcrumbCount;
 
-    if (_serverConfigUpdateInterval && _serverConfigUpdateInterval != _currentServerConfigUpdateInterval && _requestTimer)
+    if (_serverConfigUpdateInterval && _serverConfigUpdateInterval != _currentServerConfigUpdateInterval && [CountlyTimerWheel.sharedInstance hasTaskWithIdentifier:kCountlyTimerTaskServerConfig])
     {
         _currentServerConfigUpdateInterval = _serverConfigUpdateInterval;
-        [_requestTimer invalidate];
-        _requestTimer = nil;
-        _requestTimer = [NSTimer timerWithTimeInterval:_currentServerConfigUpdateInterval * 60 * 60 target:self selector:@selector(fetchServerConfigTimer:) userInfo:config repeats:YES];
-        [NSRunLoop.mainRunLoop addTimer:_requestTimer forMode:NSRunLoopCommonModes];
+        [self scheduleServerConfigFetch:config];
     }
 
     if (!_locationTracking && !CountlyLocationManager.sharedInstance.isLocationInfoDisabled)
@@ -534,13 +526,17 @@ static dispatch_once_t onceToken;
     }
 }
 
-- (void)fetchServerConfigTimer:(NSTimer *)timer
+- (void)scheduleServerConfigFetch:(CountlyConfig *)config
 {
-    CountlyConfig *config = (CountlyConfig *)timer.userInfo; // Retrieve CountlyConfig from userInfo
-    if (config)
+    __weak typeof(self) weakSelf = self;
+    [CountlyTimerWheel.sharedInstance scheduleTaskWithIdentifier:kCountlyTimerTaskServerConfig interval:_currentServerConfigUpdateInterval * 60 * 60 repeats:YES task:^
     {
-        [self fetchServerConfig:config];
-    }
+        if (config)
+        {
+            //NOTE: Last fetch timestamp is also updated on main thread when app enters foreground
+            dispatch_async(dispatch_get_main_queue(), ^{ [weakSelf fetchServerConfig:config]; });
+        }
+    }];
 }
 
 - (void)fetchServerConfigIfTimeIsUp
@@ -578,10 +574,9 @@ static dispatch_once_t onceToken;
 
     _lastFetchTimestamp = NSDate.date.timeIntervalSince1970 * 1000;
 
-    if (!_requestTimer)
+    if (![CountlyTimerWheel.sharedInstance hasTaskWithIdentifier:kCountlyTimerTaskServerConfig])
     {
-        _requestTimer = [NSTimer timerWithTimeInterval:_currentServerConfigUpdateInterval * 60 * 60 target:self selector:@selector(fetchServerConfigTimer:) userInfo:config repeats:YES];
-        [NSRunLoop.mainRunLoop addTimer:_requestTimer forMode:NSRunLoopCommonModes];
+        [self scheduleServerConfigFetch:config];
     }
 
     id handler = ^(NSData *data, NSURLResponse *response, NSError *error) {
@@ -682,16 +677,18 @@ static dispatch_once_t onceToken;
     _dropOldRequestTime = 0;
     _contentZoneInterval = 0;
 
-    _eventFilterSet = [NSSet set];
+    _eventFilter = [CountlyKeyMatcher matcherWithPatterns:@[]];
     _eventFilterIsWhitelist = NO;
-    _userPropertyFilterSet = [NSSet set];
+    _userPropertyFilter = [CountlyKeyMatcher matcherWithPatterns:@[]];
     _userPropertyFilterIsWhitelist = NO;
     _userPropertyCacheLimit = 100;
-    _segmentationFilterSet = [NSSet set];
+    _segmentationFilter = [CountlyKeyMatcher matcherWithPatterns:@[]];
     _segmentationFilterIsWhitelist = NO;
-    _eventSegmentationFilterMap = @{};
+    _eventSegmentationFilters = [CountlyKeyMatcher matcherWithPatterns:@[]];
     _eventSegmentationFilterIsWhitelist = NO;
-    _journeyTriggerEvents = [NSSet set];
+    _journeyTriggerEvents = [CountlyKeyMatcher matcherWithPatterns:@[]];
+
+    [CountlyEventRouter.sharedInstance invalidate];
 }
 
 - (void)disableSDKBehaviourSettings {
@@ -877,19 +874,20 @@ static dispatch_once_t onceToken;
     }
 }
 
+//NOTE: Filter entries may be exact keys, prefixes (`checkout_*`) or globs (`*_debug`). They are compiled into matchers once here, instead of on every check.
 - (void)updateListingFilters:(NSMutableDictionary *)dictionary logString:(NSMutableString *)logString
 {
     // Event filter (eb/ew) - blacklist takes precedence
     NSArray *eb = dictionary[kREventBlacklist];
     NSArray *ew = dictionary[kREventWhitelist];
     if ([eb isKindOfClass:NSArray.class]) {
-        _eventFilterSet = [NSSet setWithArray:eb];
+        _eventFilter = [CountlyKeyMatcher matcherWithPatterns:eb];
         _eventFilterIsWhitelist = NO;
         [logString appendFormat:@"%@: %@, ", kREventBlacklist, eb];
         if (ew)
             [dictionary removeObjectForKey:kREventWhitelist]; // blacklist takes precedence
     } else if ([ew isKindOfClass:NSArray.class]) {
-        _eventFilterSet = [NSSet setWithArray:ew];
+        _eventFilter = [CountlyKeyMatcher matcherWithPatterns:ew];
         _eventFilterIsWhitelist = YES;
         [logString appendFormat:@"%@: %@, ", kREventWhitelist, ew];
     } else {
@@ -903,13 +901,13 @@ static dispatch_once_t onceToken;
     NSArray *upb = dictionary[kRUserPropertyBlacklist];
     NSArray *upw = dictionary[kRUserPropertyWhitelist];
     if ([upb isKindOfClass:NSArray.class]) {
-        _userPropertyFilterSet = [NSSet setWithArray:upb];
+        _userPropertyFilter = [CountlyKeyMatcher matcherWithPatterns:upb];
         _userPropertyFilterIsWhitelist = NO;
         [logString appendFormat:@"%@: %@, ", kRUserPropertyBlacklist, upb];
         if (upw)
             [dictionary removeObjectForKey:kRUserPropertyWhitelist];
     } else if ([upw isKindOfClass:NSArray.class]) {
-        _userPropertyFilterSet = [NSSet setWithArray:upw];
+        _userPropertyFilter = [CountlyKeyMatcher matcherWithPatterns:upw];
         _userPropertyFilterIsWhitelist = YES;
         [logString appendFormat:@"%@: %@, ", kRUserPropertyWhitelist, upw];
     } else {
@@ -923,13 +921,13 @@ static dispatch_once_t onceToken;
     NSArray *sb = dictionary[kRSegmentationBlacklist];
     NSArray *sw = dictionary[kRSegmentationWhitelist];
     if ([sb isKindOfClass:NSArray.class]) {
-        _segmentationFilterSet = [NSSet setWithArray:sb];
+        _segmentationFilter = [CountlyKeyMatcher matcherWithPatterns:sb];
         _segmentationFilterIsWhitelist = NO;
         [logString appendFormat:@"%@: %@, ", kRSegmentationBlacklist, sb];
         if (sw)
             [dictionary removeObjectForKey:kRSegmentationWhitelist];
     } else if ([sw isKindOfClass:NSArray.class]) {
-        _segmentationFilterSet = [NSSet setWithArray:sw];
+        _segmentationFilter = [CountlyKeyMatcher matcherWithPatterns:sw];
         _segmentationFilterIsWhitelist = YES;
         [logString appendFormat:@"%@: %@, ", kRSegmentationWhitelist, sw];
     } else {
@@ -946,10 +944,10 @@ static dispatch_once_t onceToken;
         NSMutableDictionary *map = NSMutableDictionary.new;
         [esb enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSArray *obj, BOOL *stop) {
             if ([obj isKindOfClass:NSArray.class]) {
-                map[key] = [NSSet setWithArray:obj];
+                map[key] = [CountlyKeyMatcher matcherWithPatterns:obj];
             }
         }];
-        _eventSegmentationFilterMap = map.copy;
+        _eventSegmentationFilters = [CountlyKeyMatcher matcherWithPatternsAndObjects:map];
         _eventSegmentationFilterIsWhitelist = NO;
         [logString appendFormat:@"%@: %@, ", kREventSegmentationBlacklist, esb];
         if (esw)
@@ -958,10 +956,10 @@ static dispatch_once_t onceToken;
         NSMutableDictionary *map = NSMutableDictionary.new;
         [esw enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSArray *obj, BOOL *stop) {
             if ([obj isKindOfClass:NSArray.class]) {
-                map[key] = [NSSet setWithArray:obj];
+                map[key] = [CountlyKeyMatcher matcherWithPatterns:obj];
             }
         }];
-        _eventSegmentationFilterMap = map.copy;
+        _eventSegmentationFilters = [CountlyKeyMatcher matcherWithPatternsAndObjects:map];
         _eventSegmentationFilterIsWhitelist = YES;
         [logString appendFormat:@"%@: %@, ", kREventSegmentationWhitelist, esw];
     } else {
@@ -974,7 +972,7 @@ static dispatch_once_t onceToken;
     // Journey trigger events (jte)
     NSArray *jte = dictionary[kRJourneyTriggerEvents];
     if ([jte isKindOfClass:NSArray.class]) {
-        _journeyTriggerEvents = [NSSet setWithArray:jte];
+        _journeyTriggerEvents = [CountlyKeyMatcher matcherWithPatterns:jte];
         [logString appendFormat:@"%@: %@, ", kRJourneyTriggerEvents, jte];
     } else {
         if (jte)
@@ -984,24 +982,28 @@ static dispatch_once_t onceToken;
 
 - (BOOL)shouldRecordEvent:(NSString *)eventKey
 {
-    if (_eventFilterSet.count == 0) return YES;
-    return _eventFilterIsWhitelist == [_eventFilterSet containsObject:eventKey];
+    if (_eventFilter.count == 0) return YES;
+    return _eventFilterIsWhitelist == [_eventFilter matchesKey:eventKey];
 }
 
 - (BOOL)shouldRecordUserProperty:(NSString *)propertyKey
 {
-    if (_userPropertyFilterSet.count == 0) return YES;
-    return _userPropertyFilterIsWhitelist == [_userPropertyFilterSet containsObject:propertyKey];
+    if (_userPropertyFilter.count == 0) return YES;
+    return _userPropertyFilterIsWhitelist == [_userPropertyFilter matchesKey:propertyKey];
 }
 
 - (NSDictionary *)filterSegmentation:(NSDictionary *)segmentation eventKey:(NSString *)eventKey
+{
+    return [self filterSegmentation:segmentation eventKey:eventKey eventFilter:[self eventSegmentationFilterForEventKey:eventKey]];
+}
+
+- (NSDictionary *)filterSegmentation:(NSDictionary *)segmentation eventKey:(NSString *)eventKey eventFilter:(CountlyKeyMatcher *)eventFilter
 {
     if (!segmentation) {
         return segmentation;
     }
 
-    BOOL hasGlobalFilter = _segmentationFilterSet.count > 0;
-    NSSet *eventFilter = _eventSegmentationFilterMap[eventKey];
+    BOOL hasGlobalFilter = _segmentationFilter.count > 0;
     BOOL hasEventFilter = eventFilter.count > 0;
 
     if (!hasGlobalFilter && !hasEventFilter) {
@@ -1010,11 +1012,11 @@ static dispatch_once_t onceToken;
 
     NSMutableDictionary *result = [segmentation mutableCopy];
     for (NSString *key in segmentation.allKeys) {
-        if (hasGlobalFilter && _segmentationFilterIsWhitelist != [_segmentationFilterSet containsObject:key]) {
+        if (hasGlobalFilter && _segmentationFilterIsWhitelist != [_segmentationFilter matchesKey:key]) {
             CLY_LOG_D(@"Filtering out segmentation key '%@' by global segmentation filter", key);
             [result removeObjectForKey:key];
         }
-        else if (hasEventFilter && _eventSegmentationFilterIsWhitelist != [eventFilter containsObject:key]) {
+        else if (hasEventFilter && _eventSegmentationFilterIsWhitelist != [eventFilter matchesKey:key]) {
             CLY_LOG_D(@"Filtering out segmentation key '%@' for event '%@' by event segmentation filter", key, eventKey);
             [result removeObjectForKey:key];
         }
@@ -1025,7 +1027,28 @@ static dispatch_once_t onceToken;
 
 - (BOOL)isJourneyTriggerEvent:(NSString *)eventKey
 {
-    return [_journeyTriggerEvents containsObject:eventKey];
+    return [_journeyTriggerEvents matchesKey:eventKey];
+}
+
+- (CountlyKeyMatcher *)eventSegmentationFilterForEventKey:(NSString *)eventKey
+{
+    return [_eventSegmentationFilters objectForKey:eventKey];
+}
+
+- (BOOL)hasGlobalSegmentationFilter
+{
+    return _segmentationFilter.count > 0;
+}
+
+- (BOOL)isSegmentationKey:(NSString *)key allowedWithEventFilter:(CountlyKeyMatcher *)eventFilter
+{
+    if (_segmentationFilter.count > 0 && _segmentationFilterIsWhitelist != [_segmentationFilter matchesKey:key])
+        return NO;
+
+    if (eventFilter.count > 0 && _eventSegmentationFilterIsWhitelist != [eventFilter matchesKey:key])
+        return NO;
+
+    return YES;
 }
 
 @end
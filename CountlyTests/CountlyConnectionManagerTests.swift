@@ -76,6 +76,324 @@ class CountlyConnectionManagerTests: CountlyBaseTestCase {
         
     }
     
+    func test_queryEssentials_cachedPrefixFollowsDeviceIDChange() throws {
+        let config = createBaseConfig()
+        config.deviceID = "first device"
+        Countly.sharedInstance().start(with: config)
+        
+        let first = try XCTUnwrap(CountlyConnectionManager.sharedInstance().queryEssentials())
+        XCTAssertTrue(first.contains("&device_id=first%20device&t=0&"))
+        XCTAssertTrue(first.hasSuffix("&sdk_version=\(CountlyCommon.sharedInstance().sdkVersion)&sdk_name=\(CountlyCommon.sharedInstance().sdkName)"))
+        
+        Countly.sharedInstance().changeDeviceIDWithoutMerge("second_device")
+        let second = try XCTUnwrap(CountlyConnectionManager.sharedInstance().queryEssentials())
+        XCTAssertEqual("second_device", (second as NSString).cly_value(forQueryStringKey: "device_id"))
+    }
+    
+    func test_checksum_streamingMatchesConcatenatedHash() throws {
+        XCTAssertEqual("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", ("abc" as NSString).cly_SHA256())
+        XCTAssertEqual(("abcsalt" as NSString).cly_SHA256(), ("abc" as NSString).cly_SHA256(withSuffix: "salt"))
+        
+        let config = createBaseConfig()
+        config.secretSalt = "salt"
+        Countly.sharedInstance().start(with: config)
+        
+        let signed = CountlyConnectionManager.sharedInstance().appendChecksum("a=1&b=2")
+        XCTAssertEqual("a=1&b=2&checksum256=\(("a=1&b=2salt" as NSString).cly_SHA256())", signed)
+    }
+
+    func test_queryStringScan_rangesAndValues() throws {
+        let queryString = "app_key=abc&timestamp=1700000000123&ts=1&events=%5B%7B%22key%22%3A%22a%22%7D%5D&app_key=other&empty=&novalue" as NSString
+
+        XCTAssertEqual("abc", queryString.cly_value(forQueryStringKey: "app_key"))
+        XCTAssertEqual("[{\"key\":\"a\"}]", queryString.cly_value(forQueryStringKey: "events"))
+        XCTAssertEqual("", queryString.cly_value(forQueryStringKey: "empty"))
+        XCTAssertNil(queryString.cly_value(forQueryStringKey: "novalue"))
+        XCTAssertNil(queryString.cly_value(forQueryStringKey: "time"))
+        XCTAssertEqual(1700000000123, queryString.cly_longLongValue(forQueryStringKey: "timestamp"))
+        XCTAssertEqual(1, queryString.cly_longLongValue(forQueryStringKey: "ts"))
+        XCTAssertEqual(0, queryString.cly_longLongValue(forQueryStringKey: "missing"))
+
+        let range = queryString.cly_rangeOfValue(forQueryStringKey: "events")
+        XCTAssertEqual("%5B%7B%22key%22%3A%22a%22%7D%5D", queryString.substring(with: range))
+        XCTAssertEqual(NSNotFound, queryString.cly_rangeOfValue(forQueryStringKey: "missing").location)
+    }
+
+    func largeEventsQueryString() -> String {
+        let events = (0..<500).map { "{\"key\":\"event_\($0)\",\"count\":1,\"segmentation\":{\"a\":\"value \($0)\"}}" }
+        return "app_key=abc&device_id=device&events=\(("[\(events.joined(separator: ","))]" as NSString).cly_URLEscaped())&timestamp=1700000000123&hour=10&dow=3&tz=180"
+    }
+
+    func test_queryStringScan_legacyURLComponentsPerformance() throws {
+        let queryString = largeEventsQueryString()
+        measure {
+            for _ in 0..<100 {
+                let components = URLComponents(string: "http://example.com/path?" + queryString)
+                _ = components?.queryItems?.first(where: { $0.name == "timestamp" })?.value
+            }
+        }
+    }
+
+    func test_queryStringScan_scannerPerformance() throws {
+        let queryString = largeEventsQueryString() as NSString
+        measure {
+            for _ in 0..<100 {
+                _ = queryString.cly_longLongValue(forQueryStringKey: "timestamp")
+            }
+        }
+    }
+
+    func test_requestQueue_evictsLowPriorityLanesFirst() throws {
+        let config = createBaseConfig()
+        config.storedRequestsLimit = 5
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+
+        let persistency = try XCTUnwrap(CountlyPersistency.sharedInstance())
+        persistency.flushQueue()
+        persistency.add(toQueue: "&begin_session=1")
+        persistency.add(toQueue: "&crash=CRASH")
+        persistency.add(toQueue: "&user_details=USER")
+        persistency.add(toQueue: "&apm=APM")
+        persistency.add(toQueue: "&events=EVENTS0")
+        persistency.add(toQueue: "&events=EVENTS1")
+
+        guard let queuedRequests = persistency.value(forKey: "queuedRequests") as? [String] else {
+            fatalError("Failed to get queuedRequests from CountlyPersistency")
+        }
+
+        XCTAssertEqual(5, queuedRequests.count)
+        XCTAssertTrue(queuedRequests[0].contains("begin_session=1"))
+        XCTAssertTrue(queuedRequests[1].contains("crash=CRASH"))
+        XCTAssertTrue(queuedRequests[2].contains("user_details=USER"))
+        XCTAssertTrue(queuedRequests[3].contains("events=EVENTS0"))
+        XCTAssertTrue(queuedRequests[4].contains("events=EVENTS1"))
+    }
+
+    func test_requestQueue_keepsEventsWithSessionDurationUntilControlEviction() throws {
+        let config = createBaseConfig()
+        config.storedRequestsLimit = 3
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+
+        let persistency = try XCTUnwrap(CountlyPersistency.sharedInstance())
+        persistency.flushQueue()
+        persistency.add(toQueue: "&events=EVENTS0&session_duration=10")
+        persistency.add(toQueue: "&session_duration=20")
+        persistency.add(toQueue: "&events=EVENTS1")
+        persistency.add(toQueue: "&events=EVENTS2")
+        persistency.add(toQueue: "&events=EVENTS3")
+
+        guard let queuedRequests = persistency.value(forKey: "queuedRequests") as? [String] else {
+            fatalError("Failed to get queuedRequests from CountlyPersistency")
+        }
+
+        let requests = queuedRequests.map { $0.components(separatedBy: "&app_version=")[0] }
+        XCTAssertEqual(["&events=EVENTS0&session_duration=30", "&events=EVENTS2", "&events=EVENTS3"], requests)
+    }
+
+    func test_requestQueue_weightedLanesWithControlBarrier() throws {
+        let config = createBaseConfig()
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+
+        let persistency = try XCTUnwrap(CountlyPersistency.sharedInstance())
+        persistency.flushQueue()
+        persistency.add(toQueue: "&events=EVENTS0")
+        persistency.add(toQueue: "&crash=CRASH")
+        persistency.add(toQueue: "&end_session=1")
+        persistency.add(toQueue: "&events=EVENTS1")
+
+        func drainQueue() -> [String] {
+            var sendingOrder: [String] = []
+            while let next = persistency.nextItemInQueue() {
+                sendingOrder.append(String(next.split(separator: "&")[0]))
+                persistency.remove(fromQueue: next)
+            }
+            return sendingOrder
+        }
+
+        XCTAssertEqual(["crash=CRASH", "events=EVENTS0", "end_session=1", "events=EVENTS1"], drainQueue())
+
+        // User details and events keep their relative order, only APM takes turns with them
+        persistency.add(toQueue: "&user_details=USER0")
+        persistency.add(toQueue: "&events=EVENTS2")
+        persistency.add(toQueue: "&user_details=USER1")
+        persistency.add(toQueue: "&apm=APM")
+        persistency.add(toQueue: "&events=EVENTS3")
+
+        let sendingOrder = drainQueue()
+        XCTAssertTrue(sendingOrder.contains("apm=APM"))
+        XCTAssertEqual(["user_details=USER0", "events=EVENTS2", "user_details=USER1", "events=EVENTS3"], sendingOrder.filter { !$0.hasPrefix("apm=") })
+    }
+
+    func test_requestQueue_coalescesSupersededControlRequests() throws {
+        let config = createBaseConfig()
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+
+        let persistency = try XCTUnwrap(CountlyPersistency.sharedInstance())
+        persistency.flushQueue()
+        persistency.add(toQueue: "&begin_session=1")
+        persistency.add(toQueue: "&consent=FIRST")
+        persistency.add(toQueue: "&session_duration=10")
+        persistency.add(toQueue: "&events=EVENTS0")
+        persistency.add(toQueue: "&location=1,2")
+        persistency.add(toQueue: "&session_duration=20")
+        persistency.add(toQueue: "&consent=SECOND")
+        persistency.add(toQueue: "&location=3,4")
+        persistency.add(toQueue: "&end_session=1&session_duration=5")
+        persistency.add(toQueue: "&session_duration=7")
+
+        guard let queuedRequests = persistency.value(forKey: "queuedRequests") as? [String] else {
+            fatalError("Failed to get queuedRequests from CountlyPersistency")
+        }
+
+        let requests = queuedRequests.map { $0.components(separatedBy: "&app_version=")[0] }
+        XCTAssertEqual(["&begin_session=1", "&consent=FIRST", "&events=EVENTS0", "&session_duration=30", "&consent=SECOND", "&location=3,4", "&end_session=1&session_duration=5", "&session_duration=7"], requests)
+    }
+
+    func test_updateSessionAndSendEvents_piggybacksSessionDuration() throws {
+        let config = createBaseConfig()
+        config.manualSessionHandling = true
+        config.enableOrientationTracking = false
+        Countly.sharedInstance().start(with: config)
+        Countly.sharedInstance().beginSession()
+
+        Countly.sharedInstance().recordEvent("piggyback")
+        CountlyConnectionManager.sharedInstance().updateSessionAndSendEvents()
+
+        guard let queuedRequests = CountlyPersistency.sharedInstance().value(forKey: "queuedRequests") as? [String], let last = queuedRequests.last else {
+            fatalError("Failed to get queuedRequests from CountlyPersistency")
+        }
+
+        XCTAssertTrue(last.contains("events="))
+        XCTAssertTrue(last.contains("session_duration="))
+        XCTAssertFalse(queuedRequests.dropLast().contains { $0.contains("session_duration=") })
+
+        // No events this tick, heartbeat is merged into the pending events request instead of being queued separately
+        let countBefore = CountlyPersistency.sharedInstance().remainingRequestCount()
+        CountlyConnectionManager.sharedInstance().updateSessionAndSendEvents()
+        XCTAssertEqual(countBefore, CountlyPersistency.sharedInstance().remainingRequestCount())
+
+        guard let mergedRequests = CountlyPersistency.sharedInstance().value(forKey: "queuedRequests") as? [String], let merged = mergedRequests.last else {
+            fatalError("Failed to get queuedRequests from CountlyPersistency")
+        }
+        XCTAssertGreaterThanOrEqual((merged as NSString).cly_longLongValue(forQueryStringKey: "session_duration"), (last as NSString).cly_longLongValue(forQueryStringKey: "session_duration"))
+
+        // Any other pending request does not suppress the heartbeat
+        CountlyPersistency.sharedInstance().flushQueue()
+        CountlyPersistency.sharedInstance().add(toQueue: "&method=ab&keys=%5B%5D")
+        CountlyConnectionManager.sharedInstance().updateSessionAndSendEvents()
+        let heartbeats = (CountlyPersistency.sharedInstance().value(forKey: "queuedRequests") as? [String])?.filter { $0.contains("session_duration=") }
+        XCTAssertEqual(1, heartbeats?.count)
+    }
+
+    class FakeNetworkStateProvider: NSObject, CountlyNetworkStateProvider {
+        var currentLinkType: CLYNetworkLinkType = .unmetered
+        var powerConstrained = false
+        @objc var linkTypeChangeHandler: ((CLYNetworkLinkType, CLYNetworkLinkType) -> Void)?
+
+        func linkType() -> CLYNetworkLinkType { currentLinkType }
+        func isPowerConstrained() -> Bool { powerConstrained }
+    }
+
+    func test_sendScheduling_defersNonUrgentLanesOnConstrainedLinks() throws {
+        let config = createBaseConfig()
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+
+        let provider = FakeNetworkStateProvider()
+        let connectionManager = try XCTUnwrap(CountlyConnectionManager.sharedInstance())
+        connectionManager.networkStateProvider = provider
+
+        // Not in the middle of sending a batch
+        connectionManager.setValue(nil, forKey: "startTime")
+
+        let persistency = try XCTUnwrap(CountlyPersistency.sharedInstance())
+        persistency.flushQueue()
+        persistency.add(toQueue: "&events=EVENTS0")
+        XCTAssertFalse(connectionManager.shouldDeferQueue())
+
+        provider.currentLinkType = .offline
+        XCTAssertTrue(connectionManager.shouldDeferQueue())
+
+        provider.currentLinkType = .metered
+        XCTAssertTrue(connectionManager.shouldDeferQueue())
+        for i in 1..<5 {
+            persistency.add(toQueue: "&events=EVENTS\(i)")
+        }
+        XCTAssertFalse(connectionManager.shouldDeferQueue(), "A full batch should be sent on a metered link")
+
+        persistency.flushQueue()
+        persistency.add(toQueue: "&apm=APM")
+        provider.currentLinkType = .unmetered
+        provider.powerConstrained = true
+        XCTAssertTrue(connectionManager.shouldDeferQueue())
+
+        persistency.add(toQueue: "&crash=CRASH")
+        provider.currentLinkType = .offline
+        XCTAssertFalse(connectionManager.shouldDeferQueue(), "Urgent lanes should never be deferred")
+    }
+
+    func test_sendScheduling_proceedsOnQueueWhenBackOnline() throws {
+        let config = createBaseConfig()
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+
+        let provider = FakeNetworkStateProvider()
+        provider.currentLinkType = .offline
+        let connectionManager = try XCTUnwrap(CountlyConnectionManager.sharedInstance())
+        connectionManager.networkStateProvider = provider
+        let handler = try XCTUnwrap(provider.linkTypeChangeHandler, "Connection manager should subscribe to link type changes")
+
+        let persistency = try XCTUnwrap(CountlyPersistency.sharedInstance())
+        persistency.flushQueue()
+        persistency.add(toQueue: "&events=EVENTS0")
+        connectionManager.setValue(nil, forKey: "startTime")
+        connectionManager.proceedOnQueue()
+        XCTAssertNil(connectionManager.value(forKey: "startTime"), "Queue should be deferred while offline")
+
+        provider.currentLinkType = .unmetered
+        handler(.offline, .unmetered)
+        XCTAssertNotNil(connectionManager.value(forKey: "startTime"), "Queue should proceed once back online")
+    }
+
+    /**
+     * Host selection with fallback hosts
+     * unmeasured hosts are used in the given order, then the fastest healthy host is preferred
+     * a host with a connection error cools down and requests fail over to the next fastest one
+     */
+    func test_hostSelector_prefersFastestHealthyHostAndFailsOver() throws {
+        let selector = CountlyHostSelector(hosts: ["https://a.test", "https://b.test", "https://c.test"])
+        XCTAssertEqual(selector.currentHost(), "https://a.test")
+
+        selector.recordSuccess(forHost: "https://a.test", roundTripTime: 0.2)
+        selector.recordSuccess(forHost: "https://b.test", roundTripTime: 0.05)
+        selector.recordSuccess(forHost: "https://c.test", roundTripTime: 0.3)
+        XCTAssertEqual(selector.currentHost(), "https://b.test")
+
+        selector.recordFailure(forHost: "https://b.test")
+        XCTAssertGreaterThan(selector.errorRate(forHost: "https://b.test"), 0)
+        XCTAssertEqual(selector.currentHost(), "https://a.test")
+        XCTAssertTrue(selector.hasHealthyHostOther(than: "https://b.test"))
+
+        selector.recordFailure(forHost: "https://a.test")
+        selector.recordFailure(forHost: "https://a.test")
+        selector.recordFailure(forHost: "https://c.test")
+        XCTAssertFalse(selector.hasHealthyHostOther(than: "https://c.test"))
+        XCTAssertEqual(selector.currentHost(), "https://b.test", "If all hosts are cooling down, the one recovering first should be used")
+
+        Countly.sharedInstance().start(with: createBaseConfig())
+        let connectionManager = try XCTUnwrap(CountlyConnectionManager.sharedInstance())
+        connectionManager.host = "https://primary.test/"
+        connectionManager.fallbackHosts = ["https://fallback.test/", "https://primary.test"]
+        for _ in 0..<40 {
+            XCTAssertEqual(connectionManager.host, "https://primary.test", "Reading host should not select another one")
+        }
+        connectionManager.fallbackHosts = nil
+    }
+
     /**
      * addCustomNetworkRequestHeaders after SDK init
      * validate that added network headers are existing with outgoing requests
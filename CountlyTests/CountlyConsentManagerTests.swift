@@ -64,6 +64,31 @@ class CountlyConsentManagerTests: CountlyBaseTestCase {
         TestUtils.validateRequest(["consent": consents], 3)
 
     }
+
+    /**
+     * Tests that consent changes are reflected in event recording decisions.
+     * Verifies that:
+     * 1. Events are not recorded before events consent is given
+     * 2. Events are recorded after events consent is given
+     * 3. Events are not recorded after events consent is cancelled again
+     */
+    func test_eventConsentChanges_affectEventRecording() {
+        let config = TestUtils.createBaseConfig()
+        config.requiresConsent = true
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+
+        Countly.sharedInstance().recordEvent("consent_event")
+        XCTAssertEqual(0, TestUtils.getCurrentEQ()?.count)
+
+        Countly.sharedInstance().giveConsent(forFeature: CLYConsent.events)
+        Countly.sharedInstance().recordEvent("consent_event")
+        XCTAssertEqual(1, TestUtils.getCurrentEQ()?.count)
+
+        Countly.sharedInstance().cancelConsent(forFeature: CLYConsent.events)
+        Countly.sharedInstance().recordEvent("consent_event")
+        XCTAssertEqual(0, TestUtils.getCurrentEQ()?.count)
+    }
     
 }
 
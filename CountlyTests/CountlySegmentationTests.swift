@@ -122,4 +122,84 @@ class CountlySegmentationTests: CountlyBaseTestCase {
             
         }
     }
+    
+    func test_Event_Segmentation_limitEnforcedOnSanitizedOutput() {
+        cleanupState()
+        let config = createBaseConfig()
+        config.requiresConsent = false;
+        config.sdkInternalLimits().setMaxSegmentationValues(3)
+        Countly.sharedInstance().start(with: config)
+        
+        // Invalid values must not consume limit slots
+        let segmentation: [String: Any] = [
+            "invalid1": Date(),
+            "invalid2": Date(),
+            "invalid3": Date(),
+            "key1": 1,
+            "key2": 2,
+            "key3": 3,
+            "key4": 4
+        ]
+        
+        Countly.sharedInstance().recordEvent("EventKey", segmentation: segmentation)
+        
+        guard let recordedEvents =  CountlyPersistency.sharedInstance().value(forKey: "recordedEvents") as? [CountlyEvent] else {
+            fatalError("Failed to get recordedEvents from CountlyPersistency")
+        }
+        XCTAssertEqual(1, recordedEvents.count)
+        XCTAssertEqual(3, recordedEvents[0].segmentation.count)
+        XCTAssertNil(recordedEvents[0].segmentation["invalid1"])
+        config.sdkInternalLimits().setMaxSegmentationValues(100)
+    }
+    
+    // MARK: - Performance Tests
+    
+    /// Legacy multi-pass chain: type filter, truncate and limit, each producing a new dictionary
+    func test_Segmentation_legacyChainPerformance() {
+        Countly.sharedInstance().start(with: createBaseConfig())
+        let segmentation = benchmarkSegmentation()
+        
+        measure(metrics: [XCTClockMetric()]) {
+            for _ in 0..<10_000 {
+                autoreleasepool {
+                    let filtered = segmentation.cly_filterSupportedDataTypes()
+                    let truncated = (filtered as NSDictionary).cly_truncated("Event segmentation")
+                    _ = (truncated as NSDictionary).cly_limited("Event segmentation")
+                }
+            }
+        }
+    }
+    
+    /// Single-pass sanitizer producing the same output as the legacy chain
+    func test_Segmentation_singlePassPerformance() {
+        Countly.sharedInstance().start(with: createBaseConfig())
+        let segmentation = benchmarkSegmentation()
+        
+        let filtered = segmentation.cly_filterSupportedDataTypes()
+        let legacy = ((filtered as NSDictionary).cly_truncated("Event segmentation") as NSDictionary).cly_limited("Event segmentation")
+        XCTAssertEqual(legacy as NSDictionary, segmentation.cly_sanitizedSegmentation("Event segmentation") as NSDictionary)
+        
+        measure(metrics: [XCTClockMetric()]) {
+            for _ in 0..<10_000 {
+                autoreleasepool {
+                    _ = segmentation.cly_sanitizedSegmentation("Event segmentation")
+                }
+            }
+        }
+    }
+    
+    private func benchmarkSegmentation() -> NSDictionary {
+        let segmentation: [String: Any] = [
+            "intKey": 42,
+            "boolKey": true,
+            "stringKey": "Hello, World!",
+            "longStringKey": String(repeating: "x", count: 512),
+            "arrayKey": ["one", 2, 3.14],
+            "intArrayKey": [1, 2, 3],
+            "doubleKey": 3.14,
+            "invalidArrayKey": ["one", 2, Date()],
+            "invalidValueKey": Date()
+        ]
+        return segmentation as NSDictionary
+    }
 }
@@ -1445,6 +1445,76 @@ class CountlyServerConfigTests: CountlyBaseTestCase {
         }
     }
 
+    // MARK: - Listing Filter Pattern Tests
+
+    /**
+     * Tests that listing filters accept prefix and glob patterns next to exact keys.
+     * Verifies that:
+     * 1. Exact, prefix and glob entries in event blacklist block matching events
+     * 2. Prefix and glob entries work for segmentation, event segmentation and user property filters
+     * 3. Keys that do not match any pattern are unaffected
+     */
+    func test_listingFilters_prefixAndGlobPatterns() throws {
+        let sc = ServerConfigBuilder()
+            .eventBlacklist(["exact_event", "checkout_*", "*.debug", "screen_?"])
+            .segmentationBlacklist(["internal_*"])
+            .eventSegmentationBlacklist(["purchase_*": ["card_*"]])
+            .userPropertyWhitelist(["profile.*", "plan"])
+        let _ = setupTestAllFeatures(sc.buildJson())
+
+        let serverConfig = try XCTUnwrap(CountlyServerConfig.sharedInstance())
+        XCTAssertFalse(serverConfig.shouldRecordEvent("exact_event"))
+        XCTAssertFalse(serverConfig.shouldRecordEvent("checkout_started"))
+        XCTAssertFalse(serverConfig.shouldRecordEvent("checkout_"))
+        XCTAssertFalse(serverConfig.shouldRecordEvent("network.debug"))
+        XCTAssertFalse(serverConfig.shouldRecordEvent("screen_1"))
+        XCTAssertTrue(serverConfig.shouldRecordEvent("screen_10"))
+        XCTAssertTrue(serverConfig.shouldRecordEvent("checkout"))
+        XCTAssertTrue(serverConfig.shouldRecordEvent("exact_event_2"))
+        XCTAssertTrue(serverConfig.shouldRecordEvent("network.debug.info"))
+
+        XCTAssertTrue(serverConfig.shouldRecordUserProperty("profile.age"))
+        XCTAssertTrue(serverConfig.shouldRecordUserProperty("plan"))
+        XCTAssertFalse(serverConfig.shouldRecordUserProperty("planet"))
+
+        let filtered = try XCTUnwrap(serverConfig.filterSegmentation(["internal_id": 1, "card_type": "visa", "amount": 3], eventKey: "purchase_done"))
+        XCTAssertEqual(["amount": 3] as NSDictionary, filtered as NSDictionary)
+        let unfiltered = try XCTUnwrap(serverConfig.filterSegmentation(["internal_id": 1, "card_type": "visa"], eventKey: "refund"))
+        XCTAssertEqual(["card_type": "visa"] as NSDictionary, unfiltered as NSDictionary)
+    }
+
+    /**
+     * Tests key matcher precedence and memoization.
+     */
+    func test_keyMatcher_precedenceAndRepeatedLookups() {
+        let matcher = CountlyKeyMatcher(patternsAndObjects: ["checkout_*": "prefix", "checkout_done": "exact", "checkout_*_v2": "glob", "*": "any"])
+        XCTAssertEqual(4, matcher.count)
+        for _ in 0..<2 {
+            XCTAssertEqual("exact", matcher.object(forKey: "checkout_done") as? String)
+            XCTAssertEqual("prefix", matcher.object(forKey: "checkout_start_v2") as? String)
+            XCTAssertEqual("any", matcher.object(forKey: "other") as? String)
+            XCTAssertEqual("any", matcher.object(forKey: "") as? String)
+        }
+
+        let globs = CountlyKeyMatcher(patterns: ["a*b*c", "x?z", 5])
+        XCTAssertEqual(2, globs.count)
+        XCTAssertTrue(globs.matchesKey("abc"))
+        XCTAssertTrue(globs.matchesKey("a__b__c"))
+        XCTAssertFalse(globs.matchesKey("a__c__b"))
+        XCTAssertTrue(globs.matchesKey("xyz"))
+        XCTAssertFalse(globs.matchesKey("xz"))
+        XCTAssertFalse(CountlyKeyMatcher(patterns: []).matchesKey("anything"))
+
+        let escaped = CountlyKeyMatcher(patterns: ["Rate us\\?", "50\\%\\*", "dir\\\\*", "*\\?x"])
+        XCTAssertTrue(escaped.matchesKey("Rate us?"))
+        XCTAssertFalse(escaped.matchesKey("Rate usX"))
+        XCTAssertTrue(escaped.matchesKey("50\\%*"))
+        XCTAssertFalse(escaped.matchesKey("50\\%abc"))
+        XCTAssertTrue(escaped.matchesKey("dir\\file"))
+        XCTAssertTrue(escaped.matchesKey("why?x"))
+        XCTAssertFalse(escaped.matchesKey("whyyx"))
+    }
+
     // MARK: - User Property Cache Limit Tests (upcl)
 
     /**
@@ -1508,7 +1578,7 @@ class CountlyServerConfigTests: CountlyBaseTestCase {
      * Tests that recording a JTE event forces flush of the event queue.
      * Verifies that:
      * 1. Regular events stay in event queue (high threshold)
-     * 2. JTE event forces immediate flush of all events to RQ
+     * 2. JTE event forces a flush of all events to RQ after the coalescing window
      * 3. Flushed request contains callback_id (for JTE callback)
      */
     func test_journeyTriggerEvents_triggersEventFlush() {
@@ -1526,14 +1596,68 @@ class CountlyServerConfigTests: CountlyBaseTestCase {
 
         // Record JTE event - should force flush all events to RQ
         Countly.sharedInstance().recordEvent("jte_event")
-        XCTAssertEqual(1, TestUtils.getCurrentRQ()?.count)
+        TestUtils.sleep(1) {
+            XCTAssertEqual(1, TestUtils.getCurrentRQ()?.count)
+            XCTAssertEqual(0, TestUtils.getCurrentEQ()?.count)
+
+            // Verify the flushed request contains both events and has callback_id
+            let rq = TestUtils.getCurrentRQ()!
+            XCTAssertTrue(rq[0].contains("regular_event"))
+            XCTAssertTrue(rq[0].contains("jte_event"))
+            XCTAssertTrue(rq[0].contains("callback_id"))
+        }
+    }
+
+    /**
+     * Tests that a burst of JTE events is coalesced.
+     * JTE events recorded within the coalescing window should be flushed in one request with one callback.
+     */
+    func test_journeyTriggerEvents_burstIsCoalesced() {
+        let sc = ServerConfigBuilder()
+            .journeyTriggerEvents(["jte_event"])
+            .eventQueueSize(100)
+        let _ = setupTestAllFeatures(sc.buildJson())
+
+        Countly.sharedInstance().recordEvent("jte_event")
+        Countly.sharedInstance().recordEvent("regular_event")
+        Countly.sharedInstance().recordEvent("jte_event")
+        Countly.sharedInstance().recordEvent("jte_event")
+        XCTAssertEqual(0, TestUtils.getCurrentRQ()?.count)
+        XCTAssertEqual(4, TestUtils.getCurrentEQ()?.count)
+
+        TestUtils.sleep(1) {
+            XCTAssertEqual(1, TestUtils.getCurrentRQ()?.count)
+            XCTAssertEqual(0, TestUtils.getCurrentEQ()?.count)
+
+            let rq = TestUtils.getCurrentRQ()!
+            XCTAssertTrue(rq[0].contains("regular_event"))
+            XCTAssertEqual(1, rq[0].components(separatedBy: "callback_id").count - 1)
+        }
+    }
+
+    /**
+     * Tests that JTE callback waits for events already queued by a threshold flush.
+     * Coalesced flush finds no recorded events, so a marker carrying the callback is queued after the events request.
+     */
+    func test_journeyTriggerEvents_thresholdFlushKeepsCallbackAfterEvents() {
+        let sc = ServerConfigBuilder()
+            .journeyTriggerEvents(["jte_event"])
+            .eventQueueSize(2)
+        let _ = setupTestAllFeatures(sc.buildJson())
+
+        Countly.sharedInstance().recordEvent("jte_event")
+        Countly.sharedInstance().recordEvent("regular_event")
         XCTAssertEqual(0, TestUtils.getCurrentEQ()?.count)
 
-        // Verify the flushed request contains both events and has callback_id
-        let rq = TestUtils.getCurrentRQ()!
-        XCTAssertTrue(rq[0].contains("regular_event"))
-        XCTAssertTrue(rq[0].contains("jte_event"))
-        XCTAssertTrue(rq[0].contains("callback_id"))
+        TestUtils.sleep(1) {
+            let rq = TestUtils.getCurrentRQ()!
+            XCTAssertEqual(2, rq.count)
+            XCTAssertTrue(rq[0].contains("jte_event"))
+            XCTAssertFalse(rq[0].contains("callback_id"))
+            XCTAssertFalse(rq[1].contains("events="))
+            XCTAssertTrue(rq[1].contains("queue_marker"))
+            XCTAssertTrue(rq[1].contains("callback_id"))
+        }
     }
 
     /**
@@ -1556,14 +1680,16 @@ class CountlyServerConfigTests: CountlyBaseTestCase {
 
         // Record JTE event - should flush ALL events
         Countly.sharedInstance().recordEvent("journey_event")
-        XCTAssertEqual(1, TestUtils.getCurrentRQ()?.count)
-        XCTAssertEqual(0, TestUtils.getCurrentEQ()?.count)
+        TestUtils.sleep(1) {
+            XCTAssertEqual(1, TestUtils.getCurrentRQ()?.count)
+            XCTAssertEqual(0, TestUtils.getCurrentEQ()?.count)
 
-        // Verify all events in the flushed request
-        let rq = TestUtils.getCurrentRQ()!
-        XCTAssertTrue(rq[0].contains("regular_event"))
-        XCTAssertTrue(rq[0].contains("another_regular"))
-        XCTAssertTrue(rq[0].contains("journey_event"))
+            // Verify all events in the flushed request
+            let rq = TestUtils.getCurrentRQ()!
+            XCTAssertTrue(rq[0].contains("regular_event"))
+            XCTAssertTrue(rq[0].contains("another_regular"))
+            XCTAssertTrue(rq[0].contains("journey_event"))
+        }
     }
 
     /**
@@ -1584,8 +1710,10 @@ class CountlyServerConfigTests: CountlyBaseTestCase {
 
         // Record a non-blacklisted JTE - should trigger flush
         Countly.sharedInstance().recordEvent("allowed_jte")
-        XCTAssertEqual(1, TestUtils.getCurrentRQ()?.count)
-        XCTAssertEqual(0, TestUtils.getCurrentEQ()?.count)
+        TestUtils.sleep(1) {
+            XCTAssertEqual(1, TestUtils.getCurrentRQ()?.count)
+            XCTAssertEqual(0, TestUtils.getCurrentEQ()?.count)
+        }
     }
 
     // MARK: - Mutual Exclusivity Tests
@@ -35,7 +35,369 @@ class CountlyTests: CountlyBaseTestCase {
         XCTAssertTrue(Countly.sharedInstance().deviceID() == sdkGeneratedDeviceID, "Countly device id not match with provided device id.")
         XCTAssertTrue(Countly.sharedInstance().deviceIDType() == CLYDeviceIDType.IDFV, "Countly deviced id type should be custom when device id is provided during init.")
     }
+
+    func testStartupStageDurations_recordedForEachStage() throws {
+        XCTAssertTrue(Countly.sharedInstance().startupStageDurations().isEmpty)
+
+        Countly.sharedInstance().start(with: createBaseConfig())
+
+        let durations = Countly.sharedInstance().startupStageDurations()
+        let synchronousStages: [CLYStartupStage] = [.core, .session, .crashReporting, .viewTracking, .features, .consents]
+        var sum = 0.0
+        for stage in synchronousStages {
+            let duration = try XCTUnwrap(durations[stage], "Missing duration for stage \(stage.rawValue)")
+            XCTAssertGreaterThanOrEqual(duration.doubleValue, 0)
+            sum += duration.doubleValue
+        }
+        XCTAssertEqual(try XCTUnwrap(durations[.total]).doubleValue, sum, accuracy: 1.0)
+
+        TestUtils.sleep(1) {
+            XCTAssertNotNil(Countly.sharedInstance().startupStageDurations()[.deferred])
+        }
+    }
+
+    // MARK: - Bulk Event Tests
     
+    func testRecordEvents_bulkWithBackfill() throws {
+        let config = createBaseConfig()
+        config.requiresConsent = false
+        config.eventSendThreshold = 100
+        Countly.sharedInstance().start(with: config)
+        
+        let historicalTimestamp: Int64 = 1_600_000_000_000
+        let events: [[String: Any]] = [
+            ["key": "bulk1", "segmentation": ["a": 1], "count": 3, "sum": 1.5],
+            ["key": "bulk2", "sg": ["b": "c"], "timestamp": historicalTimestamp, "dur": 2],
+            ["segmentation": ["a": 1]],               // missing key
+            ["key": "[CLY]_view"],                    // reserved key
+            ["key": "bulk3", "segmentation": "bad", "count": -2]   // invalid segmentation is ignored, negative count is recorded as 1
+        ]
+        Countly.sharedInstance().recordEvents(events)
+        
+        guard let recordedEvents = CountlyPersistency.sharedInstance().value(forKey: "recordedEvents") as? [CountlyEvent] else {
+            fatalError("Failed to get recordedEvents from CountlyPersistency")
+        }
+        XCTAssertEqual(3, recordedEvents.count)
+        XCTAssertEqual("bulk1", recordedEvents[0].key)
+        XCTAssertEqual(3, recordedEvents[0].count)
+        XCTAssertEqual(1.5, recordedEvents[0].sum)
+        XCTAssertEqual(1, recordedEvents[0].segmentation["a"] as? Int)
+        XCTAssertEqual("bulk2", recordedEvents[1].key)
+        XCTAssertEqual("c", recordedEvents[1].segmentation["b"] as? String)
+        XCTAssertEqual(Int64(recordedEvents[1].timestamp * 1000), historicalTimestamp)
+        XCTAssertEqual(2, recordedEvents[1].duration)
+        XCTAssertEqual(recordedEvents[0].id, recordedEvents[1].peid)
+        XCTAssertEqual("bulk3", recordedEvents[2].key)
+        XCTAssertEqual(1, recordedEvents[2].count)
+        
+        Countly.sharedInstance().recordEvents(withJSONString: "[{\"key\":\"json1\",\"count\":\"many\"},{\"key\":\"json2\",\"sg\":{\"x\":1}}]")
+        Countly.sharedInstance().recordEvents(withJSONString: "{\"key\":\"notAnArray\"}")
+        let allEvents = CountlyPersistency.sharedInstance().value(forKey: "recordedEvents") as? [CountlyEvent]
+        XCTAssertEqual(5, allEvents?.count)
+        XCTAssertEqual(1, allEvents?[3].count)
+    }
+    
+    func testEventArena_serializationMatchesDictionaryRepresentation() throws {
+        let events: [CountlyEvent] = (0..<3).map { i in
+            let event = CountlyEvent()
+            event.key = "arenaKey"
+            event.id = "id\(i)"
+            event.cvid = "view"
+            event.peid = i > 0 ? "id\(i - 1)" : ""
+            event.segmentation = ["s": "quote\"d\n", "i": i, "b": true, "d": 1.25, "a": ["x", 2]]
+            event.count = 2
+            event.sum = 0.1
+            event.timestamp = 1_700_000_000.123
+            event.hourOfDay = 10
+            event.dayOfWeek = 3
+            event.duration = 4
+            return event
+        }
+        
+        let arena = CountlyEventArena()
+        arena.appendEvents(events)
+        XCTAssertEqual(3, arena.count)
+        
+        let streamed = try JSONSerialization.jsonObject(with: arena.serializedEvents()!) as! NSArray
+        let expected = try JSONSerialization.jsonObject(with: JSONSerialization.data(withJSONObject: events.map { $0.dictionaryRepresentation() })) as! NSArray
+        XCTAssertEqual(expected, streamed)
+        XCTAssertEqual(true, ((streamed[0] as! NSDictionary)["segmentation"] as! NSDictionary)["b"] as? Bool)
+        
+        let materialized = arena.events()
+        XCTAssertEqual("id1", materialized[1].id)
+        XCTAssertEqual("id0", materialized[1].peid)
+        XCTAssertEqual(3, materialized.count)
+        
+        arena.removeAllEvents()
+        XCTAssertEqual(0, arena.count)
+        XCTAssertNil(arena.serializedEvents())
+    }
+    
+    func testJSONWriter_rawAndURLEscapedModes() throws {
+        let object: [String: Any] = ["ascii": "plain_value-1.0~", "unicode": "çğü 😀", "quote": "a\"b\\c\n", "int": -3, "uint": UInt64.max, "double": 0.1, "bool": false, "array": [1, "two", ["nested": true]], "null": NSNull()]
+        
+        let raw = CountlyJSONWriter(mode: .raw)
+        XCTAssertTrue(raw.writeObject(object))
+        let parsed = try JSONSerialization.jsonObject(with: raw.data) as! NSDictionary
+        XCTAssertEqual(object as NSDictionary, parsed)
+        
+        let escaped = CountlyJSONWriter(mode: .urlEscaped)
+        XCTAssertTrue(escaped.writeObject(object))
+        XCTAssertEqual((raw.string() as NSString).cly_URLEscaped(), escaped.string())
+        
+        escaped.reset()
+        XCTAssertFalse(escaped.writeObject(["date": Date()]))
+        XCTAssertNil((["invalid": Double.nan] as NSDictionary).cly_JSONify())
+
+        raw.reset()
+        XCTAssertTrue(raw.writeObject(["nul": "a\u{0}b"]))
+        XCTAssertEqual("a\u{0}b", (try JSONSerialization.jsonObject(with: raw.data) as! NSDictionary)["nul"] as? String)
+
+        var deep: Any = "leaf"
+        for _ in 0..<100 {
+            deep = [deep]
+        }
+        raw.reset()
+        XCTAssertFalse(raw.writeObject(["deep": deep, "after": 1]))
+        XCTAssertNotNil(try? JSONSerialization.jsonObject(with: raw.data), "Output should stay well-formed when depth limit is exceeded")
+    }
+
+    func testClock_uniqueTimestampsAndCachedCalendarFields() throws {
+        let clock = CountlyClock.sharedInstance()
+        let iterations = 2000
+        let threads = 8
+        let lock = NSLock()
+        var timestamps = [[Int64]]()
+        DispatchQueue.concurrentPerform(iterations: threads) { _ in
+            var local = [Int64]()
+            local.reserveCapacity(iterations)
+            for _ in 0..<iterations {
+                local.append(clock.uniqueTimestampInMilliseconds())
+            }
+            lock.lock()
+            timestamps.append(local)
+            lock.unlock()
+        }
+
+        for local in timestamps {
+            XCTAssertEqual(local, local.sorted(), "Timestamps should increase on each thread")
+        }
+        let all = timestamps.flatMap { $0 }
+        XCTAssertEqual(all.count, Set(all).count, "Timestamps should be unique across threads")
+
+        let components = Calendar(identifier: .gregorian).dateComponents([.hour, .weekday], from: Date())
+        XCTAssertEqual(clock.hourOfDay(), components.hour)
+        XCTAssertEqual(clock.dayOfWeek(), components.weekday! - 1)
+        XCTAssertEqual(clock.timeZone(), TimeZone.current.secondsFromGMT() / 60)
+
+        let start = clock.monotonicTime()
+        Thread.sleep(forTimeInterval: 0.05)
+        XCTAssertGreaterThanOrEqual(clock.monotonicTime() - start, 0.05)
+    }
+
+    func testEventIDGenerator_formatUniquenessAndBatches() throws {
+        let generator = CountlyEventIDGenerator.sharedInstance()
+        let base64Characters = CharacterSet(charactersIn: "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/")
+
+        let single = generator.nextID()
+        XCTAssertEqual(21, single.count)
+        XCTAssertTrue(String(single.prefix(8)).unicodeScalars.allSatisfy { base64Characters.contains($0) })
+        let timestamp = try XCTUnwrap(Int64(single.suffix(13)))
+        XCTAssertEqual(Double(timestamp), Date().timeIntervalSince1970 * 1000, accuracy: 1000)
+
+        let lock = NSLock()
+        var ids = [String]()
+        DispatchQueue.concurrentPerform(iterations: 8) { i in
+            let local = i % 2 == 0 ? (0..<2000).map { _ in generator.nextID() } : generator.nextIDs(2000)
+            lock.lock()
+            ids.append(contentsOf: local)
+            lock.unlock()
+        }
+        XCTAssertEqual(16000, ids.count)
+        XCTAssertEqual(ids.count, Set(ids).count, "Event IDs should be unique across threads and batches")
+        XCTAssertEqual(ids.count, Set(ids.map { $0.prefix(8) }).count, "Random parts should not repeat within a process")
+        XCTAssertTrue(generator.nextIDs(0).isEmpty)
+    }
+
+    func testEventIDGenerator_performanceLegacy() throws {
+        measure {
+            for _ in 0..<10000 {
+                var random = Data(count: 6)
+                random.withUnsafeMutableBytes { arc4random_buf($0.baseAddress, 6) }
+                _ = String(format: "%@%lld", random.base64EncodedString(), Int64(CountlyCommon.sharedInstance().uniqueTimestamp() * 1000))
+            }
+        }
+    }
+
+    func testEventIDGenerator_performanceGenerator() throws {
+        let generator = CountlyEventIDGenerator.sharedInstance()
+        measure {
+            for _ in 0..<10000 {
+                _ = generator.nextID()
+            }
+        }
+    }
+
+    func testEventIDGenerator_performanceBatch() throws {
+        let generator = CountlyEventIDGenerator.sharedInstance()
+        measure {
+            _ = generator.nextIDs(10000)
+        }
+    }
+
+    func testRemoteConfigSnapshot_typedValuesParsedOnce() throws {
+        let values: [String: CountlyRCData] = [
+            "flag": CountlyRCData(value: true, isCurrentUsersData: true),
+            "flagString": CountlyRCData(value: "TRUE", isCurrentUsersData: true),
+            "count": CountlyRCData(value: "42", isCurrentUsersData: true),
+            "ratio": CountlyRCData(value: " 1.5 ", isCurrentUsersData: true),
+            "json": CountlyRCData(value: "{\"a\":[1,2]}", isCurrentUsersData: true),
+            "object": CountlyRCData(value: ["b": 1], isCurrentUsersData: true),
+            "text": CountlyRCData(value: "hello", isCurrentUsersData: true)
+        ]
+        let snapshot = CountlyRemoteConfigSnapshot(values: values)
+
+        XCTAssertTrue(snapshot.boolValue(forKey: "flag", defaultValue: false))
+        XCTAssertTrue(snapshot.boolValue(forKey: "flagString", defaultValue: false))
+        XCTAssertEqual(42, snapshot.longLongValue(forKey: "count", defaultValue: 0))
+        XCTAssertEqual(42.0, snapshot.doubleValue(forKey: "count", defaultValue: 0))
+        XCTAssertEqual(1.5, snapshot.doubleValue(forKey: "ratio", defaultValue: 0))
+        XCTAssertEqual(["a": [1, 2]] as NSDictionary, snapshot.jsonObject(forKey: "json") as? NSDictionary)
+        XCTAssertEqual(["b": 1] as NSDictionary, snapshot.jsonObject(forKey: "object") as? NSDictionary)
+        XCTAssertEqual("{\"b\":1}", snapshot.stringValue(forKey: "object"))
+        XCTAssertEqual("hello", snapshot.stringValue(forKey: "text"))
+        XCTAssertEqual("1", snapshot.stringValue(forKey: "flag"))
+
+        XCTAssertEqual(7, snapshot.longLongValue(forKey: "text", defaultValue: 7), "Unparseable values fall back to default")
+        XCTAssertFalse(snapshot.boolValue(forKey: "missing", defaultValue: false))
+        XCTAssertNil(snapshot.jsonObject(forKey: "text"))
+        XCTAssertNil(snapshot.stringValue(forKey: "missing"))
+    }
+
+    func testRemoteConfigSnapshot_staleWithinJitteredTTL() throws {
+        let fetchTime: TimeInterval = 1_700_000_000
+        let ttl: TimeInterval = 3600
+        for _ in 0..<100 {
+            let snapshot = CountlyRemoteConfigSnapshot(values: [:], fetchTime: fetchTime)
+            XCTAssertGreaterThanOrEqual(snapshot.refreshJitter, 0.8)
+            XCTAssertLessThanOrEqual(snapshot.refreshJitter, 1.0)
+            XCTAssertFalse(snapshot.isStale(at: fetchTime + ttl * 0.79, ttl: ttl))
+            XCTAssertTrue(snapshot.isStale(at: fetchTime + ttl, ttl: ttl))
+            XCTAssertTrue(snapshot.isStale(at: fetchTime - 1, ttl: ttl), "Clock moved backwards, values should be refreshed")
+        }
+        XCTAssertTrue(CountlyRemoteConfigSnapshot(values: [:]).isStale(at: Date().timeIntervalSince1970, ttl: ttl), "Never fetched values are stale")
+    }
+
+    func testRemoteConfig_changeCallbacksReceiveOnlyDiff() throws {
+        Countly.sharedInstance().start(with: createBaseConfig())
+        let remoteConfig = try XCTUnwrap(CountlyRemoteConfig.sharedInstance())
+
+        var diffs = [(added: [String], changed: [String], removed: [String])]()
+        let changeCallback: RCChangeCallback = { added, changed, removed in
+            diffs.append((added.keys.sorted(), changed.keys.sorted(), removed.sorted()))
+        }
+        var observed = [String: Any?]()
+        let observer: RCKeyObserver = { key, value in observed[key] = value?.value }
+        remoteConfig.registerChangeCallback(changeCallback)
+        remoteConfig.registerObserver(forKey: "b", observer: observer)
+        remoteConfig.registerObserver(forKey: "c", observer: observer)
+        remoteConfig.registerObserver(forKey: "d", observer: observer)
+        defer {
+            remoteConfig.removeChangeCallback(changeCallback)
+            ["b", "c", "d"].forEach { remoteConfig.removeObserver(forKey: $0, observer: observer) }
+        }
+
+        let previous = ["a": CountlyRCData(value: 1, isCurrentUsersData: true),
+                        "b": CountlyRCData(value: "old", isCurrentUsersData: true),
+                        "c": CountlyRCData(value: true, isCurrentUsersData: true)]
+        let current = ["a": CountlyRCData(value: 1, isCurrentUsersData: true),
+                       "b": CountlyRCData(value: "new", isCurrentUsersData: true),
+                       "d": CountlyRCData(value: 5, isCurrentUsersData: true)]
+
+        let internal = try XCTUnwrap(CountlyRemoteConfigInternal.sharedInstance())
+        internal.notifyChanges(from: previous, to: current)
+        internal.notifyChanges(from: current, to: current)
+
+        XCTAssertEqual(1, diffs.count, "Updates without changes should not be notified")
+        XCTAssertEqual(["d"], diffs.first?.added)
+        XCTAssertEqual(["b"], diffs.first?.changed)
+        XCTAssertEqual(["c"], diffs.first?.removed)
+        XCTAssertEqual("new", observed["b"] as? String)
+        XCTAssertEqual(5, observed["d"] as? Int)
+        XCTAssertTrue(observed.keys.contains("c"))
+        XCTAssertNil(observed["c"]!, "Removed keys are observed with nil value")
+    }
+
+    func testRemoteConfig_enrollAndExitRequestsAreBatched() throws {
+        let config = createBaseConfig()
+        config.requiresConsent = false
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+        let remoteConfig = try XCTUnwrap(CountlyRemoteConfig.sharedInstance())
+
+        for i in 0..<20 {
+            remoteConfig.enrollIntoABTests(forKeys: ["flag\(i % 10)"])
+        }
+        remoteConfig.exitABTests(forKeys: ["flag9", "other"])
+        remoteConfig.exitABTests(forKeys: ["other"])
+
+        func requests(method: String) -> [[String: Any]] {
+            (TestUtils.getCurrentRQ() ?? []).map { TestUtils.parseQueryString($0) }.filter { $0["method"] as? String == method }
+        }
+        func keys(_ request: [String: Any]?) -> [String]? {
+            guard let json = request?["keys"] as? String, let data = json.data(using: .utf8) else { return nil }
+            return try? JSONSerialization.jsonObject(with: data) as? [String]
+        }
+        XCTAssertTrue(requests(method: "ab").isEmpty, "Enrollments should wait for the next queue turn")
+
+        TestUtils.sleep(1) {
+            let enrollRequests = requests(method: "ab")
+            XCTAssertEqual(1, enrollRequests.count)
+            XCTAssertEqual((0..<9).map { "flag\($0)" }, keys(enrollRequests.first))
+
+            let exitRequests = requests(method: "ab_opt_out")
+            XCTAssertEqual(1, exitRequests.count)
+            XCTAssertEqual(["flag9", "other"], keys(exitRequests.first))
+        }
+
+        remoteConfig.enrollIntoABTests(forKeys: ["flag0", "flag9"])
+        TestUtils.sleep(1) {
+            XCTAssertEqual(["flag9"], keys(requests(method: "ab").last), "Already enrolled keys should not be sent again")
+        }
+    }
+
+    func testTimerWheel_coDueTasksShareWakeupOffMainThread() throws {
+        let wheel = CountlyTimerWheel.sharedInstance()
+        let fired = expectation(description: "Co-due tasks fired")
+        fired.expectedFulfillmentCount = 3
+        let lock = NSLock()
+        var fireTimes: [String: TimeInterval] = [:]
+
+        let record: (String) -> Void = { identifier in
+            XCTAssertFalse(Thread.isMainThread)
+            lock.lock()
+            fireTimes[identifier] = ProcessInfo.processInfo.systemUptime
+            lock.unlock()
+            fired.fulfill()
+        }
+
+        wheel.scheduleTask(withIdentifier: "test_a", interval: 1.0, repeats: false) { record("test_a") }
+        Thread.sleep(forTimeInterval: 0.03)
+        wheel.scheduleTask(withIdentifier: "test_b", interval: 1.0, repeats: false) { record("test_b") }
+
+        // Rescheduling replaces the pending task, and cancelled tasks never fire
+        wheel.scheduleTask(withIdentifier: "test_c", interval: 0.2, repeats: false) { XCTFail("Replaced task should not fire") }
+        wheel.scheduleTask(withIdentifier: "test_c", interval: 0.4, repeats: false) { record("test_c") }
+        wheel.scheduleTask(withIdentifier: "test_d", interval: 0.2, repeats: false) { XCTFail("Cancelled task should not fire") }
+        wheel.cancelTask(withIdentifier: "test_d")
+        XCTAssertTrue(wheel.hasTask(withIdentifier: "test_a"))
+        XCTAssertFalse(wheel.hasTask(withIdentifier: "test_d"))
+
+        wait(for: [fired], timeout: 3)
+        XCTAssertEqual(fireTimes["test_a"]!, fireTimes["test_b"]!, accuracy: 0.05)
+        XCTAssertFalse(wheel.hasTask(withIdentifier: "test_a"))
+    }
+
     func testPerformanceExample() async throws {
         // This is an example of a performance test case.
         measure {
@@ -610,6 +610,36 @@ class CountlyUserProfileTests: CountlyBaseTestCase {
         XCTAssertEqual(rqBefore, rqAfter, "save() after clear() must not enqueue a request")
     }
 
+    /// Every kind of mutation marks user details dirty, and unsetting the only
+    /// pending named field clears it again.
+    func test_hasUnsyncedChanges_trackedPerMutation() {
+        let user = Countly.user()
+        _ = user.perform(NSSelectorFromString("clear"))
+        XCTAssertFalse(user.hasUnsyncedChanges())
+
+        user.setValue("Test", forKey: "name")
+        XCTAssertTrue(user.hasUnsyncedChanges())
+        user.setValue(nil, forKey: "name")
+        XCTAssertFalse(user.hasUnsyncedChanges())
+
+        user.setValue(NSNull(), forKey: "birthYear")
+        XCTAssertTrue(user.hasUnsyncedChanges())
+        _ = user.perform(NSSelectorFromString("clear"))
+
+        user.increment("key_inc")
+        XCTAssertTrue(user.hasUnsyncedChanges())
+        _ = user.perform(NSSelectorFromString("clear"))
+
+        user.setOnce("key_once", value: "value")
+        XCTAssertTrue(user.hasUnsyncedChanges())
+        _ = user.perform(NSSelectorFromString("clear"))
+
+        user.setProperty("key_custom", value: "value")
+        XCTAssertTrue(user.hasUnsyncedChanges())
+        _ = user.perform(NSSelectorFromString("clear"))
+        XCTAssertFalse(user.hasUnsyncedChanges())
+    }
+
     /// Android parity: `testCustomModifiers` (line 272)
     /// Multiple `pushUnique` calls on the same key accumulate into an array
     /// (the array-merge fix). Scalar values like `$inc` and `$mul` stay as numbers.
@@ -648,6 +678,182 @@ class CountlyUserProfileTests: CountlyBaseTestCase {
         XCTAssertEqual("test2", setArray[1] as? String)
     }
 
+    /// Repeated modifiers on the same key are composed into one modifier:
+    /// increments are summed, multipliers multiplied, max/min folded, set-adds
+    /// and pulls deduplicated, and only the first `setOnce` is kept.
+    func test_customModifiers_composedPerKey() {
+        let config = createBaseConfig()
+        config.requiresConsent = false
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+
+        let user = Countly.user()
+        user.increment("key_inc")
+        user.increment(by: "key_inc", value: 4)
+        user.increment(by: "key_inc", value: -2)
+        user.increment(by: "key_float", value: 1.5)
+        user.increment(by: "key_float", value: 1)
+        user.multiply("key_mul", value: 2)
+        user.multiply("key_mul", value: 3)
+        user.max("key_max", value: 5)
+        user.max("key_max", value: 9)
+        user.max("key_max", value: 7)
+        user.min("key_min", value: 5)
+        user.min("key_min", value: 2)
+        user.setOnce("key_once", value: "first")
+        user.setOnce("key_once", value: "second")
+        user.pushUnique("key_set", values: ["a", "b"])
+        user.pushUnique("key_set", value: "a")
+        user.pushUnique("key_set", value: "c")
+        user.pull("key_pull", value: "x")
+        user.pull("key_pull", value: "x")
+        user.save()
+
+        guard let rq = TestUtils.getCurrentRQ(),
+              let request = rq.first(where: { $0.contains("user_details=") }),
+              let userDetails = TestUtils.parseQueryString(request)["user_details"] as? [String: Any],
+              let custom = userDetails["custom"] as? [String: [String: Any]] else {
+            XCTFail("No user_details request with custom modifiers"); return
+        }
+
+        XCTAssertEqual(3, custom["key_inc"]?["$inc"] as? Int)
+        XCTAssertEqual(2.5, custom["key_float"]?["$inc"] as? Double)
+        XCTAssertEqual(6, custom["key_mul"]?["$mul"] as? Int)
+        XCTAssertEqual(9, custom["key_max"]?["$max"] as? Int)
+        XCTAssertEqual(2, custom["key_min"]?["$min"] as? Int)
+        XCTAssertEqual("first", custom["key_once"]?["$setOnce"] as? String)
+        XCTAssertEqual(["a", "b", "c"], custom["key_set"]?["$addToSet"] as? [String])
+        XCTAssertEqual(["x"], custom["key_pull"]?["$pull"] as? [String])
+    }
+
+    /// Different modifiers on the same key are sent in separate requests in the order they were made,
+    /// without flushing events or other pending properties in the middle of the calls.
+    func test_customModifiers_conflictingModifiersKeepOrder() {
+        let config = createBaseConfig()
+        config.requiresConsent = false
+        config.manualSessionHandling = true
+        config.eventSendThreshold = 100
+        Countly.sharedInstance().start(with: config)
+
+        let user = Countly.user()
+        Countly.sharedInstance().recordEvent("before_modifiers")
+        user.increment("key")
+        user.multiply("key", value: 2)
+        user.increment(by: "key", value: 3)
+        user.multiply("key", value: 5)
+        user.increment("other")
+
+        XCTAssertFalse(TestUtils.getCurrentRQ()?.contains { $0.contains("events=") || $0.contains("user_details=") } ?? false)
+        XCTAssertEqual(1, TestUtils.getCurrentEQ()?.count)
+
+        user.save()
+
+        let customs = (TestUtils.getCurrentRQ() ?? [])
+            .filter { $0.contains("user_details=") }
+            .compactMap { (TestUtils.parseQueryString($0)["user_details"] as? [String: Any])?["custom"] as? [String: [String: Any]] }
+        XCTAssertEqual(4, customs.count)
+        XCTAssertEqual(1, customs[0]["key"]?["$inc"] as? Int)
+        XCTAssertEqual(1, customs[0]["other"]?["$inc"] as? Int)
+        XCTAssertEqual(2, customs[1]["key"]?["$mul"] as? Int)
+        XCTAssertEqual(3, customs[2]["key"]?["$inc"] as? Int)
+        XCTAssertEqual(5, customs[3]["key"]?["$mul"] as? Int)
+    }
+
+    /// Values acknowledged by server are not sent again until they change.
+    /// A modifier on a key drops its acknowledged value, as the result is unknown.
+    func test_save_sendsOnlyValuesChangedSinceLastAcknowledged() {
+        let config = createBaseConfig()
+        config.requiresConsent = false
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+
+        func lastUserDetails() -> [String: Any]? {
+            guard let request = TestUtils.getCurrentRQ()?.last(where: { $0.contains("user_details=") }) else { return nil }
+            return TestUtils.parseQueryString(request)["user_details"] as? [String: Any]
+        }
+
+        let user = Countly.user()
+        user.setProperties(["name": "Test", "key1": "value1"])
+        user.save()
+        XCTAssertEqual("Test", lastUserDetails()?["name"] as? String)
+        user.userDetailsAcknowledged("{\"name\":\"Test\",\"custom\":{\"key1\":\"value1\"}}")
+
+        user.setProperties(["name": "Test", "key1": "value1", "key2": "value2"])
+        user.save()
+        let delta = lastUserDetails()
+        XCTAssertNil(delta?["name"])
+        XCTAssertEqual(["key2": "value2"], delta?["custom"] as? [String: String])
+
+        let requestCount = TestUtils.getCurrentRQ()?.count ?? 0
+        user.setProperties(["name": "Test", "key1": "value1"])
+        user.save()
+        XCTAssertEqual(requestCount, TestUtils.getCurrentRQ()?.count ?? 0, "Unchanged profile should not be sent again")
+
+        user.userDetailsAcknowledged("{\"custom\":{\"key1\":{\"$inc\":1}}}")
+        user.setProperty("key1", value: "value1")
+        user.save()
+        XCTAssertEqual(["key1": "value1"], lastUserDetails()?["custom"] as? [String: String])
+    }
+
+    func test_save_sendsAcknowledgedValueAgainWhileDifferentValueIsPending() {
+        let config = createBaseConfig()
+        config.requiresConsent = false
+        config.manualSessionHandling = true
+        Countly.sharedInstance().start(with: config)
+
+        func lastUserDetails() -> [String: Any]? {
+            guard let request = TestUtils.getCurrentRQ()?.last(where: { $0.contains("user_details=") }) else { return nil }
+            return TestUtils.parseQueryString(request)["user_details"] as? [String: Any]
+        }
+
+        let user = Countly.user()
+        user.name = "X" as CountlyUserDetailsNullableString
+        user.setProperty("score", value: "5")
+        user.save()
+        user.userDetailsAcknowledged("{\"name\":\"X\",\"custom\":{\"score\":\"5\"}}")
+
+        user.name = "Y" as CountlyUserDetailsNullableString
+        user.save()
+        user.incrementBy("score", value: 1)
+        user.save()
+
+        user.name = "X" as CountlyUserDetailsNullableString
+        user.setProperty("score", value: "5")
+        user.save()
+        let userDetails = lastUserDetails()
+        XCTAssertEqual("X", userDetails?["name"] as? String)
+        XCTAssertEqual(["score": "5"], userDetails?["custom"] as? [String: String])
+    }
+
+    func test_userDetailsAcknowledged_ignoresPreviousDeviceID() {
+        let config = createBaseConfig()
+        config.requiresConsent = false
+        config.manualSessionHandling = true
+        config.deviceID = "old_id"
+        Countly.sharedInstance().start(with: config)
+
+        func lastUserDetails() -> [String: Any]? {
+            guard let request = TestUtils.getCurrentRQ()?.last(where: { $0.contains("user_details=") }) else { return nil }
+            return TestUtils.parseQueryString(request)["user_details"] as? [String: Any]
+        }
+
+        let user = Countly.user()
+        user.name = "X" as CountlyUserDetailsNullableString
+        user.save()
+        Countly.sharedInstance().changeDeviceIDWithoutMerge("new_id")
+        user.userDetailsAcknowledged("{\"name\":\"X\"}", forDeviceID: "old_id")
+
+        user.name = "X" as CountlyUserDetailsNullableString
+        user.save()
+        XCTAssertEqual("X", lastUserDetails()?["name"] as? String)
+        user.userDetailsAcknowledged("{\"name\":\"X\"}", forDeviceID: "new_id")
+
+        let requestCount = TestUtils.getCurrentRQ()?.count ?? 0
+        user.name = "X" as CountlyUserDetailsNullableString
+        user.save()
+        XCTAssertEqual(requestCount, TestUtils.getCurrentRQ()?.count ?? 0)
+    }
+
     /// Android parity: `testCustomData` (line 243)
     /// `setProperty` with a custom key lands in the custom dict.
     func test_setProperty_customKeyLandsInCustom() {
@@ -0,0 +1,34 @@
+// CountlyTimerWheel.h
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import <Foundation/Foundation.h>
+#import "Resettable.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+extern NSString* const kCountlyTimerTaskSession;
+extern NSString* const kCountlyTimerTaskServerConfig;
+extern NSString* const kCountlyTimerTaskBackoff;
+extern NSString* const kCountlyTimerTaskContentZone;
+extern NSString* const kCountlyTimerTaskContentZoneReenter;
+extern NSString* const kCountlyTimerTaskOrientation;
+
+typedef void (^CLYTimerTask)(void);
+
+//NOTE: Single timer for all periodic and delayed SDK work, running tasks on a background queue.
+//NOTE: Deadlines are aligned to a grid based on each task's tolerance, and every task within its tolerance fires on the same wakeup.
+@interface CountlyTimerWheel : NSObject <Resettable>
+
++ (instancetype)sharedInstance;
+
+//NOTE: Scheduling a task with an existing identifier replaces it, so it can be used for debouncing as well
+- (void)scheduleTaskWithIdentifier:(NSString *)identifier interval:(NSTimeInterval)interval repeats:(BOOL)repeats task:(CLYTimerTask)task;
+- (void)cancelTaskWithIdentifier:(NSString *)identifier;
+- (BOOL)hasTaskWithIdentifier:(NSString *)identifier;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,205 @@
+// CountlyTimerWheel.m
+//
+// This code is provided under the MIT License.
+//
+// Please visit www.count.ly for more information.
+
+#import "CountlyCommon.h"
+
+NSString* const kCountlyTimerTaskSession              = @"session";
+NSString* const kCountlyTimerTaskServerConfig         = @"server_config";
+NSString* const kCountlyTimerTaskBackoff              = @"backoff";
+NSString* const kCountlyTimerTaskContentZone          = @"content_zone";
+NSString* const kCountlyTimerTaskContentZoneReenter   = @"content_zone_reenter";
+NSString* const kCountlyTimerTaskOrientation          = @"orientation";
+
+//NOTE: A task may fire this much earlier or later than its deadline, so it can share a wakeup with other tasks
+static const double kCountlyTimerToleranceRatio = 0.1;
+static const NSTimeInterval kCountlyTimerMaxTolerance = 5.0;
+
+@interface CountlyTimerWheelTask : NSObject
+@property (nonatomic, copy) CLYTimerTask block;
+@property (nonatomic) NSTimeInterval interval;
+@property (nonatomic) NSTimeInterval tolerance;
+@property (nonatomic) NSTimeInterval deadline;
+@property (nonatomic) BOOL repeats;
+@end
+
+@implementation CountlyTimerWheelTask
+@end
+
+@interface CountlyTimerWheel ()
+@property (nonatomic) NSMutableDictionary<NSString *, CountlyTimerWheelTask *>* tasks;
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) dispatch_source_t source;
+@end
+
+@implementation CountlyTimerWheel
+
+static CountlyTimerWheel* s_sharedInstance = nil;
+static dispatch_once_t onceToken;
+
++ (instancetype)sharedInstance
+{
+    dispatch_once(&onceToken, ^{s_sharedInstance = self.new;});
+    return s_sharedInstance;
+}
+
+- (instancetype)init
+{
+    if (self = [super init])
+    {
+        self.tasks = NSMutableDictionary.new;
+        self.queue = dispatch_queue_create("ly.count.timerwheel", DISPATCH_QUEUE_SERIAL);
+        self.source = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.queue);
+
+        __weak typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(self.source, ^{ [weakSelf fire]; });
+        dispatch_source_set_timer(self.source, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        dispatch_resume(self.source);
+    }
+
+    return self;
+}
+
+- (void)resetInstance
+{
+    CLY_LOG_I(@"%s", __FUNCTION__);
+    @synchronized (self)
+    {
+        [self.tasks removeAllObjects];
+        dispatch_source_cancel(self.source);
+    }
+    onceToken = 0;
+    s_sharedInstance = nil;
+}
+
+- (void)dealloc
+{
+    dispatch_source_cancel(_source);
+}
+
+#pragma mark -
+
+- (void)scheduleTaskWithIdentifier:(NSString *)identifier interval:(NSTimeInterval)interval repeats:(BOOL)repeats task:(CLYTimerTask)task
+{
+    if (!identifier || !task)
+        return;
+
+    if (repeats && interval <= 0)
+    {
+        CLY_LOG_W(@"%s, repeating task [ %@ ] needs a positive interval, it will be ignored", __FUNCTION__, identifier);
+        return;
+    }
+
+    CountlyTimerWheelTask* wheelTask = CountlyTimerWheelTask.new;
+    wheelTask.block = task;
+    wheelTask.interval = MAX(interval, 0);
+    wheelTask.tolerance = MIN(wheelTask.interval * kCountlyTimerToleranceRatio, kCountlyTimerMaxTolerance);
+    wheelTask.repeats = repeats;
+
+    @synchronized (self)
+    {
+        wheelTask.deadline = [self alignedDeadline:NSProcessInfo.processInfo.systemUptime + wheelTask.interval tolerance:wheelTask.tolerance];
+        self.tasks[identifier] = wheelTask;
+        [self rearm];
+    }
+}
+
+- (void)cancelTaskWithIdentifier:(NSString *)identifier
+{
+    if (!identifier)
+        return;
+
+    @synchronized (self)
+    {
+        if (!self.tasks[identifier])
+            return;
+
+        [self.tasks removeObjectForKey:identifier];
+        [self rearm];
+    }
+}
+
+- (BOOL)hasTaskWithIdentifier:(NSString *)identifier
+{
+    if (!identifier)
+        return NO;
+
+    @synchronized (self)
+    {
+        return self.tasks[identifier] != nil;
+    }
+}
+
+#pragma mark -
+
+- (NSTimeInterval)alignedDeadline:(NSTimeInterval)deadline tolerance:(NSTimeInterval)tolerance
+{
+    //NOTE: Rounding deadlines up to a multiple of tolerance makes tasks with similar intervals land on the same wakeup
+    if (tolerance <= 0)
+        return deadline;
+
+    return ceil(deadline / tolerance) * tolerance;
+}
+
+- (void)rearm
+{
+    CountlyTimerWheelTask* earliest = nil;
+    for (CountlyTimerWheelTask* task in self.tasks.allValues)
+    {
+        if (!earliest || task.deadline < earliest.deadline)
+            earliest = task;
+    }
+
+    if (!earliest)
+    {
+        dispatch_source_set_timer(self.source, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        return;
+    }
+
+    NSTimeInterval delay = MAX(earliest.deadline - NSProcessInfo.processInfo.systemUptime, 0);
+    dispatch_source_set_timer(self.source, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, (uint64_t)(earliest.tolerance * NSEC_PER_SEC));
+}
+
+- (void)fire
+{
+    NSMutableArray<CLYTimerTask>* dueTasks = NSMutableArray.new;
+
+    @synchronized (self)
+    {
+        NSTimeInterval now = NSProcessInfo.processInfo.systemUptime;
+
+        for (NSString* identifier in self.tasks.allKeys)
+        {
+            CountlyTimerWheelTask* task = self.tasks[identifier];
+            if (task.deadline - task.tolerance > now)
+                continue;
+
+            [dueTasks addObject:task.block];
+
+            if (!task.repeats)
+            {
+                [self.tasks removeObjectForKey:identifier];
+                continue;
+            }
+
+            //NOTE: Deadlines advance by whole intervals to stay aligned, unless wakeups were missed (e.g. while suspended)
+            NSTimeInterval nextDeadline = task.deadline + task.interval;
+            if (nextDeadline - task.tolerance <= now)
+                nextDeadline = [self alignedDeadline:now + task.interval tolerance:task.tolerance];
+
+            task.deadline = nextDeadline;
+        }
+
+        [self rearm];
+    }
+
+    //NOTE: Tasks are executed outside the lock, so they can schedule or cancel tasks themselves
+    for (CLYTimerTask task in dueTasks)
+    {
+        task();
+    }
+}
+
+@end
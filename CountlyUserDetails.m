@@ -5,10 +5,34 @@
 // Please visit www.count.ly for more information.
 
 #import "CountlyCommon.h"
+#import <stdatomic.h>
+
+//NOTE: One bit per field with pending changes, so hasUnsyncedChanges is a single load on the event recording hot path
+typedef NS_OPTIONS(NSUInteger, CountlyUserDetailsDirtyField)
+{
+    CountlyUserDetailsDirtyName                 = 1 << 0,
+    CountlyUserDetailsDirtyUsername             = 1 << 1,
+    CountlyUserDetailsDirtyEmail                = 1 << 2,
+    CountlyUserDetailsDirtyOrganization         = 1 << 3,
+    CountlyUserDetailsDirtyPhone                = 1 << 4,
+    CountlyUserDetailsDirtyGender               = 1 << 5,
+    CountlyUserDetailsDirtyPictureURL           = 1 << 6,
+    CountlyUserDetailsDirtyPictureLocalPath     = 1 << 7,
+    CountlyUserDetailsDirtyBirthYear            = 1 << 8,
+    CountlyUserDetailsDirtyCustom               = 1 << 9,
+    CountlyUserDetailsDirtyCustomProperties     = 1 << 10,
+    CountlyUserDetailsDirtyCustomMods           = 1 << 11,
+};
 
 @interface CountlyUserDetails ()
+{
+    _Atomic(NSUInteger) _dirtyFields;
+}
 @property (nonatomic) NSMutableDictionary* customMods;
+@property (nonatomic) NSMutableArray<NSMutableDictionary *>* deferredCustomMods;
 @property (nonatomic) NSMutableDictionary* customProperties;
+@property (nonatomic) NSMutableDictionary<NSString *, NSNumber *>* acknowledgedHashes;
+@property (nonatomic) NSMutableArray<NSString *>* acknowledgedKeys;
 
 - (BOOL)isValidDataType:(id) value;
 @end
@@ -35,6 +59,9 @@ NSString* const kCountlyUDKeyModifierPush       = @"$push";
 NSString* const kCountlyUDKeyModifierAddToSet   = @"$addToSet";
 NSString* const kCountlyUDKeyModifierPull       = @"$pull";
 
+//NOTE: Custom properties are cached with a prefix, so they do not collide with predefined fields of the same name
+NSString* const kCountlyUDAcknowledgedCustomKeyPrefix = @"custom.";
+
 static NSString* const kCountlyUDNamedFields[] = {
     kCountlyUDKeyName,
     kCountlyUDKeyUsername,
@@ -64,7 +91,9 @@ static const NSUInteger kCountlyUDNamedFieldsCount = sizeof(kCountlyUDNamedField
     if (self = [super init])
     {
         self.customMods = NSMutableDictionary.new;
+        self.deferredCustomMods = NSMutableArray.new;
         self.customProperties = NSMutableDictionary.new;
+        atomic_init(&_dirtyFields, 0);
     }
 
     return self;
@@ -111,6 +140,8 @@ static const NSUInteger kCountlyUDNamedFieldsCount = sizeof(kCountlyUDNamedField
     if (customAll.count > 0)
         userDictionary[kCountlyUDKeyCustom] = customAll;
 
+    [self removeAcknowledgedValuesFromUserDetails:userDictionary];
+
     if (userDictionary.count > 0)
         return [userDictionary cly_JSONify];
 
@@ -131,36 +162,97 @@ static const NSUInteger kCountlyUDNamedFieldsCount = sizeof(kCountlyUDNamedField
     self.custom = nil;
 
     [self.customMods removeAllObjects];
+    [self.deferredCustomMods removeAllObjects];
     [self.customProperties removeAllObjects];
+    [self markField:CountlyUserDetailsDirtyCustomProperties | CountlyUserDetailsDirtyCustomMods dirty:NO];
 }
 
 - (BOOL)hasUnsyncedChanges
 {
-    NSArray<NSNumber *> *userDetailsFlags = @[
-        @(self.name != nil),
-        @(self.username != nil),
-        @(self.email != nil),
-        @(self.organization != nil),
-        @(self.phone != nil),
-        @(self.gender != nil),
-        @(self.pictureURL != nil),
-        @(self.pictureLocalPath != nil),
-        @(self.birthYear != nil),
-        @(self.custom != nil)
-    ];
-    
-    __block BOOL userDetailsChanged = NO;
-    [userDetailsFlags enumerateObjectsUsingBlock:^(NSNumber * _Nonnull obj, NSUInteger idx, BOOL * _Nonnull stop) {
-        if (obj.boolValue) {
-            userDetailsChanged = YES;
-            *stop = YES;
-        }
-    }];
-    
-    return userDetailsChanged || self.customProperties.count > 0 || self.customMods.count > 0;
+    return atomic_load_explicit(&_dirtyFields, memory_order_relaxed) != 0;
+}
+
+- (void)markField:(CountlyUserDetailsDirtyField)field dirty:(BOOL)isDirty
+{
+    if (isDirty)
+        atomic_fetch_or_explicit(&_dirtyFields, field, memory_order_relaxed);
+    else
+        atomic_fetch_and_explicit(&_dirtyFields, ~field, memory_order_relaxed);
+}
+
+#pragma mark -
+
+- (void)setName:(id<CountlyUserDetailsNullableString>)name
+{
+    _name = [(id)name copy];
+    [self markField:CountlyUserDetailsDirtyName dirty:_name != nil];
+}
+
+- (void)setUsername:(id<CountlyUserDetailsNullableString>)username
+{
+    _username = [(id)username copy];
+    [self markField:CountlyUserDetailsDirtyUsername dirty:_username != nil];
+}
+
+- (void)setEmail:(id<CountlyUserDetailsNullableString>)email
+{
+    _email = [(id)email copy];
+    [self markField:CountlyUserDetailsDirtyEmail dirty:_email != nil];
 }
 
+- (void)setOrganization:(id<CountlyUserDetailsNullableString>)organization
+{
+    _organization = [(id)organization copy];
+    [self markField:CountlyUserDetailsDirtyOrganization dirty:_organization != nil];
+}
+
+- (void)setPhone:(id<CountlyUserDetailsNullableString>)phone
+{
+    _phone = [(id)phone copy];
+    [self markField:CountlyUserDetailsDirtyPhone dirty:_phone != nil];
+}
+
+- (void)setGender:(id<CountlyUserDetailsNullableString>)gender
+{
+    _gender = [(id)gender copy];
+    [self markField:CountlyUserDetailsDirtyGender dirty:_gender != nil];
+}
+
+- (void)setPictureURL:(id<CountlyUserDetailsNullableString>)pictureURL
+{
+    _pictureURL = [(id)pictureURL copy];
+    [self markField:CountlyUserDetailsDirtyPictureURL dirty:_pictureURL != nil];
+}
 
+- (void)setPictureLocalPath:(id<CountlyUserDetailsNullableString>)pictureLocalPath
+{
+    _pictureLocalPath = [(id)pictureLocalPath copy];
+    [self markField:CountlyUserDetailsDirtyPictureLocalPath dirty:_pictureLocalPath != nil];
+}
+
+- (void)setBirthYear:(id<CountlyUserDetailsNullableNumber>)birthYear
+{
+    _birthYear = [(id)birthYear copy];
+    [self markField:CountlyUserDetailsDirtyBirthYear dirty:_birthYear != nil];
+}
+
+- (void)setCustom:(id<CountlyUserDetailsNullableDictionary>)custom
+{
+    _custom = [(id)custom copy];
+    [self markField:CountlyUserDetailsDirtyCustom dirty:_custom != nil];
+}
+
+- (void)setCustomPropertyValue:(id)value forKey:(NSString *)key
+{
+    self.customProperties[key] = value;
+    [self markField:CountlyUserDetailsDirtyCustomProperties dirty:YES];
+}
+
+- (void)setCustomModValue:(NSDictionary *)value forKey:(NSString *)key inGeneration:(NSMutableDictionary *)generation
+{
+    generation[key] = value;
+    [self markField:CountlyUserDetailsDirtyCustomMods dirty:YES];
+}
 
 #pragma mark -
 
@@ -204,7 +296,7 @@ static const NSUInteger kCountlyUDNamedFieldsCount = sizeof(kCountlyUDNamedField
                           : [(NSString *)value cly_truncatedValue:truncatedLog];
     }
     NSString *truncatedKey = [key cly_truncatedKey:truncatedLog];
-    self.customProperties[truncatedKey] = value;
+    [self setCustomPropertyValue:value forKey:truncatedKey];
     // No auto-flush — legacy `set:` preserves pre-existing event-flush timing.
 }
 
@@ -235,7 +327,7 @@ static const NSUInteger kCountlyUDNamedFieldsCount = sizeof(kCountlyUDNamedField
     if (key == nil) return;
 
     NSString *truncatedKey = [key cly_truncatedKey:@"unSet"];
-    self.customProperties[truncatedKey] = NSNull.null;
+    [self setCustomPropertyValue:NSNull.null forKey:truncatedKey];
     // No auto-flush — legacy `unSet:` preserves pre-existing event-flush timing.
 }
 
@@ -361,6 +453,14 @@ static const NSUInteger kCountlyUDNamedFieldsCount = sizeof(kCountlyUDNamedField
     if (userDetails)
         [CountlyConnectionManager.sharedInstance sendUserDetails:userDetails];
 
+    //NOTE: Modifiers conflicting with earlier ones on the same key follow in separate requests, in the order they were made
+    for (NSDictionary* generation in self.deferredCustomMods)
+    {
+        NSMutableDictionary* deferredUserDetails = [@{kCountlyUDKeyCustom: generation.mutableCopy} mutableCopy];
+        [self removeAcknowledgedValuesFromUserDetails:deferredUserDetails];
+        [CountlyConnectionManager.sharedInstance sendUserDetails:[deferredUserDetails cly_JSONify]];
+    }
+
     if (self.pictureLocalPath && !self.pictureURL)
         [CountlyConnectionManager.sharedInstance sendUserDetails:[@{kCountlyLocalPicturePath: self.pictureLocalPath} cly_JSONify]];
 
@@ -390,28 +490,95 @@ static const NSUInteger kCountlyUDNamedFieldsCount = sizeof(kCountlyUDNamedField
     }
 
     NSString* truncatedKey = [[key description] cly_truncatedKey:truncatedLog];
-    if (![mod isEqualToString:@"$pull"] &&
-        ![mod isEqualToString:@"$push"] &&
-        ![mod isEqualToString:@"$addToSet"]) {
-        self.customMods[truncatedKey] = @{mod: value};
-    } else if (self.customMods[truncatedKey] && self.customMods[truncatedKey][mod]) {
-        id existing = self.customMods[truncatedKey][mod];
-        NSMutableArray *array = [existing isKindOfClass:[NSArray class]] ? [existing mutableCopy] : [NSMutableArray arrayWithObject:existing];
-        if ([value isKindOfClass:[NSArray class]]) {
-            [array addObjectsFromArray:value];
-        } else {
-            [array addObject:value];
-        }
-        self.customMods[truncatedKey] = @{mod: array};
-    } else {
-        self.customMods[truncatedKey] = @{mod: value};
+
+    //NOTE: Pending modifiers are kept as an ordered log of generations, each sent in its own user details request.
+    //NOTE: A modifier composes with the same one in the latest generation having the key.
+    //NOTE: Different modifiers on the same key can not be composed into one and their order matters (e.g. $inc then $mul), so a different one goes to the next generation.
+    NSUInteger generationIndex = self.deferredCustomMods.count;
+    while (generationIndex > 0 && !self.deferredCustomMods[generationIndex - 1][truncatedKey])
+        generationIndex--;
+
+    NSMutableDictionary* generation = generationIndex ? self.deferredCustomMods[generationIndex - 1] : self.customMods;
+    NSDictionary* pending = generation[truncatedKey];
+    id pendingValue = pending[mod];
+
+    if (pending && !pendingValue)
+    {
+        CLY_LOG_D(@"%s key [%@] has a pending [%@] modifier, [%@] will be sent in a following request", __FUNCTION__, truncatedKey, pending.allKeys.firstObject, mod);
+
+        if (generationIndex == self.deferredCustomMods.count)
+            [self.deferredCustomMods addObject:NSMutableDictionary.new];
+
+        generation = self.deferredCustomMods[generationIndex];
     }
+
+    id composedValue = pendingValue ? [self composedModifier:mod pendingValue:pendingValue value:value] : value;
+    [self setCustomModValue:@{mod: composedValue} forKey:truncatedKey inGeneration:generation];
     // Note: legacy modifier methods (setOnce/push/pull/etc.) deliberately do
     // NOT auto-flush events — preserves pre-existing request-timing behavior
     // for callers still on the legacy API. Auto-flush is opt-in via the new
     // -setProperty:/setProperties: path.
 }
 
+static NSNumber* CountlyComposedNumber(NSNumber* a, NSNumber* b, BOOL multiply)
+{
+    if (!CFNumberIsFloatType((__bridge CFNumberRef)a) && !CFNumberIsFloatType((__bridge CFNumberRef)b))
+    {
+        long long result;
+        BOOL overflow = multiply ? __builtin_mul_overflow(a.longLongValue, b.longLongValue, &result) : __builtin_add_overflow(a.longLongValue, b.longLongValue, &result);
+        if (!overflow)
+            return @(result);
+    }
+
+    return multiply ? @(a.doubleValue * b.doubleValue) : @(a.doubleValue + b.doubleValue);
+}
+
+// Composes a new modifier value with the pending one of the same modifier,
+// so a single minimal modifier per key is sent regardless of how many calls were made.
+- (id)composedModifier:(NSString *)mod pendingValue:(id)pendingValue value:(id)value
+{
+    BOOL areNumbers = [pendingValue isKindOfClass:NSNumber.class] && [value isKindOfClass:NSNumber.class];
+
+    if ([mod isEqualToString:kCountlyUDKeyModifierIncrement] && areNumbers)
+        return CountlyComposedNumber(pendingValue, value, NO);
+
+    if ([mod isEqualToString:kCountlyUDKeyModifierMultiply] && areNumbers)
+        return CountlyComposedNumber(pendingValue, value, YES);
+
+    if ([mod isEqualToString:kCountlyUDKeyModifierMax] && areNumbers)
+        return [pendingValue compare:value] == NSOrderedAscending ? value : pendingValue;
+
+    if ([mod isEqualToString:kCountlyUDKeyModifierMin] && areNumbers)
+        return [pendingValue compare:value] == NSOrderedDescending ? value : pendingValue;
+
+    //NOTE: Only the first $setOnce can take effect on server
+    if ([mod isEqualToString:kCountlyUDKeyModifierSetOnce])
+        return pendingValue;
+
+    if ([mod isEqualToString:kCountlyUDKeyModifierPush])
+    {
+        NSMutableArray* values = [pendingValue isKindOfClass:NSArray.class] ? [pendingValue mutableCopy] : [NSMutableArray arrayWithObject:pendingValue];
+        if ([value isKindOfClass:NSArray.class])
+            [values addObjectsFromArray:value];
+        else
+            [values addObject:value];
+        return values;
+    }
+
+    //NOTE: Both adding to a set and pulling from an array are idempotent per value, so duplicates are dropped
+    if ([mod isEqualToString:kCountlyUDKeyModifierAddToSet] || [mod isEqualToString:kCountlyUDKeyModifierPull])
+    {
+        NSMutableOrderedSet* values = [pendingValue isKindOfClass:NSArray.class] ? [NSMutableOrderedSet orderedSetWithArray:pendingValue] : [NSMutableOrderedSet orderedSetWithObject:pendingValue];
+        if ([value isKindOfClass:NSArray.class])
+            [values addObjectsFromArray:value];
+        else
+            [values addObject:value];
+        return values.array;
+    }
+
+    return value;
+}
+
 /**
  * This mainly performs the filtering of provided values.
  * This single call is used for both predefined properties and custom user properties.
@@ -458,7 +625,7 @@ static const NSUInteger kCountlyUDNamedFieldsCount = sizeof(kCountlyUDNamedField
             }
             NSString* truncatedKey = [[key description] cly_truncatedKey:truncatedLog];
             if ([self isValidDataType:value]) {
-                self.customProperties[truncatedKey] = value;
+                [self setCustomPropertyValue:value forKey:truncatedKey];
                 anyChange = YES;
             } else {
                 CLY_LOG_D(@"%s provided an unsupported type for key: [%@], value: [%@], type: [%@], omitting call",__FUNCTION__,
@@ -571,6 +738,216 @@ static const NSUInteger kCountlyUDNamedFieldsCount = sizeof(kCountlyUDNamedField
     }
 }
 
+#pragma mark - Acknowledged Values
+
+//NOTE: FNV-1a over JSON representation, as it needs to be stable across launches to be persisted
+static long long CountlyUserDetailsValueHash(id value)
+{
+    CountlyJSONWriter* writer = [CountlyJSONWriter.alloc initWithMode:CLYJSONWriterModeRaw];
+    if (![writer writeObject:@[value]])
+        return 0;
+
+    const uint8_t* bytes = writer.data.bytes;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (NSUInteger i = 0; i < writer.data.length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return (long long)hash;
+}
+
+- (void)loadAcknowledgedValuesIfNeeded
+{
+    if (self.acknowledgedHashes)
+        return;
+
+    self.acknowledgedHashes = NSMutableDictionary.new;
+    self.acknowledgedKeys = NSMutableArray.new;
+
+    for (NSArray* entry in [CountlyPersistency.sharedInstance retrieveUserDetailsAcknowledgedHashes])
+    {
+        if (![entry isKindOfClass:NSArray.class] || entry.count != 2 || self.acknowledgedHashes[entry[0]])
+            continue;
+
+        self.acknowledgedHashes[entry[0]] = entry[1];
+        [self.acknowledgedKeys addObject:entry[0]];
+    }
+}
+
+- (BOOL)isAcknowledgedValue:(id)value forKey:(NSString *)key
+{
+    NSNumber* acknowledgedHash = self.acknowledgedHashes[key];
+    if (!acknowledgedHash)
+        return NO;
+
+    long long hash = CountlyUserDetailsValueHash(value);
+    return hash != 0 && hash == acknowledgedHash.longLongValue;
+}
+
+//NOTE: Values equal to the acknowledged ones are omitted. Acknowledged values are compared only while no request for the key is pending.
+//NOTE: So hash of every key being sent with a different value or a modifier is dropped right away, until its request is acknowledged.
+- (void)removeAcknowledgedValuesFromUserDetails:(NSMutableDictionary *)userDictionary
+{
+    @synchronized (self)
+    {
+        [self loadAcknowledgedValuesIfNeeded];
+
+        if (!self.acknowledgedHashes.count)
+            return;
+
+        BOOL hasDroppedHashes = NO;
+
+        for (NSString* key in userDictionary.allKeys)
+        {
+            if ([key isEqualToString:kCountlyUDKeyCustom])
+                continue;
+
+            if ([self isAcknowledgedValue:userDictionary[key] forKey:key])
+            {
+                CLY_LOG_V(@"%s [%@] is not changed since last acknowledged, omitting", __FUNCTION__, key);
+                [userDictionary removeObjectForKey:key];
+            }
+            else
+            {
+                hasDroppedHashes = [self dropAcknowledgedValueForKey:key] || hasDroppedHashes;
+            }
+        }
+
+        NSMutableDictionary* custom = userDictionary[kCountlyUDKeyCustom];
+        for (NSString* key in custom.allKeys)
+        {
+            NSString* acknowledgedKey = [kCountlyUDAcknowledgedCustomKeyPrefix stringByAppendingString:key];
+
+            //NOTE: Modifiers are not idempotent, so they are always sent
+            if (![custom[key] isKindOfClass:NSDictionary.class] && [self isAcknowledgedValue:custom[key] forKey:acknowledgedKey])
+            {
+                CLY_LOG_V(@"%s custom [%@] is not changed since last acknowledged, omitting", __FUNCTION__, key);
+                [custom removeObjectForKey:key];
+            }
+            else
+            {
+                hasDroppedHashes = [self dropAcknowledgedValueForKey:acknowledgedKey] || hasDroppedHashes;
+            }
+        }
+
+        if (custom && !custom.count)
+            [userDictionary removeObjectForKey:kCountlyUDKeyCustom];
+
+        if (hasDroppedHashes)
+            [self storeAcknowledgedValues];
+    }
+}
+
+- (BOOL)dropAcknowledgedValueForKey:(NSString *)key
+{
+    if (!self.acknowledgedHashes[key])
+        return NO;
+
+    [self.acknowledgedHashes removeObjectForKey:key];
+    [self.acknowledgedKeys removeObject:key];
+    return YES;
+}
+
+- (void)setAcknowledgedValue:(id)value forKey:(NSString *)key
+{
+    [self.acknowledgedKeys removeObject:key];
+
+    //NOTE: Value modified on server is unknown afterwards, so its cached hash is dropped
+    if ([value isKindOfClass:NSDictionary.class])
+    {
+        [self.acknowledgedHashes removeObjectForKey:key];
+        return;
+    }
+
+    self.acknowledgedHashes[key] = @(CountlyUserDetailsValueHash(value));
+    [self.acknowledgedKeys addObject:key];
+}
+
+//NOTE: Acknowledged values are cleared on device ID change without merge, so a request still queued for the previous device ID is not acknowledged for the current one
+- (void)userDetailsAcknowledged:(NSString *)userDetails forDeviceID:(NSString *)deviceID
+{
+    if (![deviceID isEqualToString:CountlyDeviceInfo.sharedInstance.deviceID])
+    {
+        CLY_LOG_V(@"%s, user details were sent for a different device ID, not acknowledging", __FUNCTION__);
+        return;
+    }
+
+    [self userDetailsAcknowledged:userDetails];
+}
+
+- (void)userDetailsAcknowledged:(NSString *)userDetails
+{
+    NSDictionary* userDictionary = [NSJSONSerialization JSONObjectWithData:[userDetails cly_dataUTF8] options:0 error:nil];
+    if (![userDictionary isKindOfClass:NSDictionary.class] || userDictionary[kCountlyLocalPicturePath])
+        return;
+
+    @synchronized (self)
+    {
+        [self loadAcknowledgedValuesIfNeeded];
+
+        [userDictionary enumerateKeysAndObjectsUsingBlock:^(NSString* key, id value, BOOL* stop)
+        {
+            if (![key isEqualToString:kCountlyUDKeyCustom])
+            {
+                [self setAcknowledgedValue:value forKey:key];
+                return;
+            }
+
+            if (![value isKindOfClass:NSDictionary.class])
+                return;
+
+            [(NSDictionary *)value enumerateKeysAndObjectsUsingBlock:^(NSString* customKey, id customValue, BOOL* stop)
+            {
+                [self setAcknowledgedValue:customValue forKey:[kCountlyUDAcknowledgedCustomKeyPrefix stringByAppendingString:customKey]];
+            }];
+        }];
+
+        //NOTE: Least recently acknowledged values are evicted first
+        NSInteger limit = CountlyServerConfig.sharedInstance.userPropertyCacheLimit;
+        while (limit > 0 && self.acknowledgedKeys.count > (NSUInteger)limit)
+        {
+            [self.acknowledgedHashes removeObjectForKey:self.acknowledgedKeys.firstObject];
+            [self.acknowledgedKeys removeObjectAtIndex:0];
+        }
+
+        [self storeAcknowledgedValues];
+    }
+}
+
+- (void)storeAcknowledgedValues
+{
+    NSMutableArray* entries = [NSMutableArray arrayWithCapacity:self.acknowledgedKeys.count];
+    for (NSString* key in self.acknowledgedKeys)
+    {
+        [entries addObject:@[key, self.acknowledgedHashes[key]]];
+    }
+
+    [CountlyPersistency.sharedInstance storeUserDetailsAcknowledgedHashes:entries];
+}
+
+- (void)clearAcknowledgedValues
+{
+    CLY_LOG_D(@"%s", __FUNCTION__);
+
+    @synchronized (self)
+    {
+        self.acknowledgedHashes = NSMutableDictionary.new;
+        self.acknowledgedKeys = NSMutableArray.new;
+        [self storeAcknowledgedValues];
+    }
+}
+
+- (void)unloadAcknowledgedValues
+{
+    @synchronized (self)
+    {
+        self.acknowledgedHashes = nil;
+        self.acknowledgedKeys = nil;
+    }
+}
+
 // when user properties change, flush any
 // pending events first so they reach the server before the next user-details request.
 - (void)userPropertiesChanged
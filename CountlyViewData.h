@@ -23,6 +23,11 @@
  * @discussion set the start time when starting a view.
  */
 @property (nonatomic) NSTimeInterval viewStartTime;
+/**
+ * Monotonic starting time of view.
+ * @discussion Used for calculating the duration, so it is not affected by device clock changes.
+ */
+@property (nonatomic) NSTimeInterval viewStartMonotonicTime;
 /**
  * Is this view is auto stoppable.
  * @discussion If set then this view will automatically stopped when new view is started.
@@ -16,6 +16,7 @@
         self.viewID = viewID;
         self.viewName = viewName;
         self.viewStartTime = CountlyCommon.sharedInstance.uniqueTimestamp;
+        self.viewStartMonotonicTime = CountlyClock.sharedInstance.monotonicTime;
         self.isAutoStoppedView = false;
         self.willStartAgain = false;
     }
@@ -25,7 +26,7 @@
 
 - (NSInteger)duration
 {
-    NSTimeInterval duration = NSDate.date.timeIntervalSince1970 - self.viewStartTime;
+    NSTimeInterval duration = CountlyClock.sharedInstance.monotonicTime - self.viewStartMonotonicTime;
     return (NSInteger)round(duration); // Rounds to the nearest integer, to fix long value converted to 0 on server side.
 }
 
@@ -35,12 +36,14 @@
     {
         // For safe side we have set the value to current time stamp instead of 0 when pausing the view, as setting it to 0 could result in an invalid duration value.
         self.viewStartTime = CountlyCommon.sharedInstance.uniqueTimestamp;
+        self.viewStartMonotonicTime = CountlyClock.sharedInstance.monotonicTime;
     }
 }
 
 - (void)resumeView
 {
     self.viewStartTime = CountlyCommon.sharedInstance.uniqueTimestamp;
+    self.viewStartMonotonicTime = CountlyClock.sharedInstance.monotonicTime;
 }
 
 
@@ -128,6 +128,17 @@ NSString* const kCountlyVTKeyDur      = @"dur";
     return reservedViewTrackingSegmentationKeys;
 }
 
+- (NSSet *)reservedViewTrackingSegmentationKeySet
+{
+    static NSSet* reservedViewTrackingSegmentationKeySet = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        reservedViewTrackingSegmentationKeySet = [NSSet setWithArray:self.reservedViewTrackingSegmentationKeys];
+    });
+
+    return reservedViewTrackingSegmentationKeySet;
+}
+
 #pragma mark - Public methods
 
 - (void)setGlobalViewSegmentation:(NSMutableDictionary *)segmentation
@@ -356,34 +367,17 @@ NSString* const kCountlyVTKeyDur      = @"dur";
     CountlyViewData* viewData = self.viewDataDictionary[viewKey];
     if (viewData)
     {
-        NSMutableDictionary* segmentation = NSMutableDictionary.new;
-        
-        if (viewData.segmentation)
-        {
-            [segmentation addEntriesFromDictionary:viewData.segmentation];
-        }
-        
-        if (self.viewSegmentation)
-        {
-            [segmentation addEntriesFromDictionary:self.viewSegmentation];
-        }
+        NSMutableDictionary* segmentation = [NSMutableDictionary dictionaryWithCapacity:CountlyCommon.sharedInstance.maxSegmentationValues + 2];
         
-        if (customSegmentation)
-        {
-            NSMutableDictionary* mutableCustomSegmentation = customSegmentation.mutableCopy;
-            [mutableCustomSegmentation removeObjectsForKeys:self.reservedViewTrackingSegmentationKeys];
-            NSDictionary *filteredSegmentation = mutableCustomSegmentation.cly_filterSupportedDataTypes;
-            [segmentation addEntriesFromDictionary:filteredSegmentation];
-        }
-        
-        NSDictionary* segmentationTruncated = [segmentation cly_truncated:@"View segmentation"];
-        segmentation = [segmentationTruncated cly_limited:@"View segmentation"].mutableCopy;
+        [viewData.segmentation cly_sanitizeSegmentationInto:segmentation explanation:@"View segmentation" reservedKeys:nil route:nil];
+        [self.viewSegmentation cly_sanitizeSegmentationInto:segmentation explanation:@"View segmentation" reservedKeys:nil route:nil];
+        [customSegmentation cly_sanitizeSegmentationInto:segmentation explanation:@"View segmentation" reservedKeys:self.reservedViewTrackingSegmentationKeySet route:nil];
         
         segmentation[kCountlyVTKeyName] = viewData.viewName;
         segmentation[kCountlyVTKeySegment] = CountlyDeviceInfo.osName;
         
         NSInteger duration = viewData.duration;
-        [Countly.sharedInstance recordReservedEvent:kCountlyReservedEventView segmentation:segmentation count:1 sum:0 duration:duration ID:viewData.viewID timestamp:CountlyCommon.sharedInstance.uniqueTimestamp];
+        [Countly.sharedInstance recordSanitizedReservedEvent:kCountlyReservedEventView segmentation:segmentation count:1 sum:0 duration:duration ID:viewData.viewID timestamp:CountlyCommon.sharedInstance.uniqueTimestamp];
         
         CLY_LOG_D(@"%s View tracking ended: %@ duration: %ld", __FUNCTION__, viewData.viewName, (long)duration);
         if (!autoPaused) {
@@ -422,23 +416,10 @@ NSString* const kCountlyVTKeyDur      = @"dur";
     
     viewName = [viewName cly_truncatedKey:@"View name"];
     
-    NSMutableDictionary* segmentation = NSMutableDictionary.new;
-    
-    if (self.viewSegmentation)
-    {
-        [segmentation addEntriesFromDictionary:self.viewSegmentation];
-    }
-    
-    if (customSegmentation)
-    {
-        NSMutableDictionary* mutableCustomSegmentation = customSegmentation.mutableCopy;
-        [mutableCustomSegmentation removeObjectsForKeys:self.reservedViewTrackingSegmentationKeys];
-        NSDictionary *filteredSegmentation = mutableCustomSegmentation.cly_filterSupportedDataTypes;
-        [segmentation addEntriesFromDictionary:filteredSegmentation];
-    }
+    NSMutableDictionary* segmentation = [NSMutableDictionary dictionaryWithCapacity:CountlyCommon.sharedInstance.maxSegmentationValues + 4];
     
-    NSDictionary* segmentationTruncated = [segmentation cly_truncated:@"View segmentation"];
-    segmentation = [segmentationTruncated cly_limited:@"View segmentation"].mutableCopy;
+    [self.viewSegmentation cly_sanitizeSegmentationInto:segmentation explanation:@"View segmentation" reservedKeys:nil route:nil];
+    [customSegmentation cly_sanitizeSegmentationInto:segmentation explanation:@"View segmentation" reservedKeys:self.reservedViewTrackingSegmentationKeySet route:nil];
     
     segmentation[kCountlyVTKeyName] = viewName;
     segmentation[kCountlyVTKeySegment] = CountlyDeviceInfo.osName;
@@ -461,7 +442,7 @@ NSString* const kCountlyVTKeyDur      = @"dur";
     viewData.isAutoStoppedView = isAutoStoppedView;
     self.viewDataDictionary[self.currentViewID] = viewData;
     
-    [Countly.sharedInstance recordReservedEvent:kCountlyReservedEventView segmentation:segmentation ID:self.currentViewID];
+    [Countly.sharedInstance recordSanitizedReservedEvent:kCountlyReservedEventView segmentation:segmentation count:1 sum:0 duration:0 ID:self.currentViewID timestamp:CountlyCommon.sharedInstance.uniqueTimestamp];
     
     CLY_LOG_D(@"%s View name: %@ View ID: %@ isAutoStoppedView: %@", __FUNCTION__, viewName, self.currentViewID, isAutoStoppedView ? @"YES" : @"NO");
     
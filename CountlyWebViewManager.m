@@ -463,23 +463,34 @@
             CLY_LOG_I(@"Events array should not be empty or nil, and should be of type NSArray");
             return;
     }
+    NSMutableArray *validEvents = [NSMutableArray arrayWithCapacity:events.count];
     for (NSDictionary *event in events) {
-            NSString *key = event[@"key"];
-            NSDictionary *segmentation = event[@"segmentation"];
-            NSDictionary *sg = event[@"sg"];
-            if(!key) {
+            if(![event isKindOfClass:[NSDictionary class]] || ![event[@"key"] isKindOfClass:[NSString class]]) {
                 CLY_LOG_I(@"Skipping the event due to key is empty or nil");
                 continue;
             }
-            if(sg) {
-                segmentation = sg;
-            }
-            if(!segmentation) {
+            if(!event[@"sg"] && !event[@"segmentation"]) {
                 CLY_LOG_I(@"Skipping the event due to missing segmentation");
                 continue;
             }
 
-            [Countly.sharedInstance recordEvent:key segmentation:segmentation];
+            //NOTE: Widgets send reserved events (e.g. [CLY]_nps, [CLY]_survey, [CLY]_star_rating), which bulk API does not accept.
+            //NOTE: So they are recorded one by one as before, after the events collected so far to keep the order.
+            if ([CountlyEventRouter.sharedInstance routeForEventKey:event[@"key"]].isReserved) {
+                if (validEvents.count) {
+                    [Countly.sharedInstance recordEvents:validEvents];
+                    [validEvents removeAllObjects];
+                }
+
+                [Countly.sharedInstance recordEvent:event[@"key"] segmentation:event[@"sg"] ?: event[@"segmentation"]];
+                continue;
+            }
+
+            [validEvents addObject:event];
+    }
+
+    if (validEvents.count) {
+        [Countly.sharedInstance recordEvents:validEvents];
     }
 
     [CountlyConnectionManager.sharedInstance attemptToSendStoredRequests];
@@ -55,6 +55,7 @@ let package = Package(
                 .linkedFramework("CoreLocation"),
                 .linkedFramework("WebKit", .when(platforms: [.iOS])),
                 .linkedFramework("CoreTelephony", .when(platforms: [.iOS])),
+                .linkedFramework("Network", .when(platforms: [.iOS])),
             ]),
         .testTarget(
             name: "CountlyTests",